@@ -0,0 +1,85 @@
+#include "AtomicFile.h"
+#include <fstream>
+#include <system_error>
+
+#include "Logger.h"
+
+namespace AtomicFile {
+
+uint64_t hash(std::string_view data)
+{
+	uint64_t value = 14695981039346656037ull;
+	for (unsigned char c : data) {
+		value ^= c;
+		value *= 1099511628211ull;
+	}
+	return value;
+}
+
+bool read(const std::filesystem::path& path, std::string& content)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file.is_open()) {
+		return false;
+	}
+	std::error_code error;
+	uintmax_t size = std::filesystem::file_size(path, error);
+	content.clear();
+	if (!error) {
+		content.resize(static_cast<size_t>(size));
+		file.read(content.data(), static_cast<std::streamsize>(size));
+		content.resize(static_cast<size_t>(file.gcount()));
+	}
+	return true;
+}
+
+bool hasContent(const std::filesystem::path& path, std::string_view content)
+{
+	// Size first, most changes are caught without reading the file
+	std::error_code error;
+	uintmax_t size = std::filesystem::file_size(path, error);
+	if (error || size != content.size()) {
+		return false;
+	}
+	std::string existing;
+	return read(path, existing) && existing.size() == content.size() && hash(existing) == hash(content);
+}
+
+bool write(const std::filesystem::path& path, std::string_view content)
+{
+	std::filesystem::path tempPath = path;
+	tempPath += ".tmp";
+	{
+		std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) {
+			LOG_ERROR << "Failed to open " << tempPath.string() << " for writing.";
+			return false;
+		}
+		file.write(content.data(), static_cast<std::streamsize>(content.size()));
+		file.flush();
+		if (!file) {
+			LOG_ERROR << "Failed to write " << tempPath.string() << ".";
+			file.close();
+			std::filesystem::remove(tempPath);
+			return false;
+		}
+	}
+
+	std::error_code error;
+	std::filesystem::rename(tempPath, path, error);
+	if (!error) {
+		return true;
+	}
+
+	// The target can be locked by its reader on Windows, write it in place rather than not at all
+	LOG_WARNING << "Could not replace " << path.string() << " (" << error.message() << "), writing it in place.";
+	std::filesystem::remove(tempPath, error);
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file.is_open()) {
+		return false;
+	}
+	file.write(content.data(), static_cast<std::streamsize>(content.size()));
+	return static_cast<bool>(file);
+}
+
+} // namespace AtomicFile
@@ -0,0 +1,20 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+// Whole-file writes for files other programs read while ARAS runs (EuroScope
+// reads the .rwy file): the content goes to a temporary file next to the
+// target which then replaces it, so readers see either the old or the new file.
+namespace AtomicFile {
+
+// 64 bit FNV-1a
+uint64_t hash(std::string_view data);
+
+bool read(const std::filesystem::path& path, std::string& content);
+// True when the file exists with exactly this content
+bool hasContent(const std::filesystem::path& path, std::string_view content);
+bool write(const std::filesystem::path& path, std::string_view content);
+
+} // namespace AtomicFile
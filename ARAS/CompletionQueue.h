@@ -0,0 +1,58 @@
+#pragma once
+#include <atomic>
+#include <utility>
+
+// Lock-free multi-producer / single-consumer queue used to hand results from
+// worker threads back to the GUI thread. Producers push onto an intrusive
+// stack, the consumer takes the whole stack at once and replays it in FIFO order.
+template <typename T>
+class CompletionQueue {
+public:
+	CompletionQueue() = default;
+	~CompletionQueue() { drain([](T&&) {}); }
+
+	CompletionQueue(const CompletionQueue&) = delete;
+	CompletionQueue& operator=(const CompletionQueue&) = delete;
+
+	void push(T value)
+	{
+		Node* node = new Node{ std::move(value), m_head.load(std::memory_order_relaxed) };
+		while (!m_head.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) {
+		}
+	}
+
+	// Consumer side only. Returns the number of items handled.
+	template <typename F>
+	size_t drain(F&& handler)
+	{
+		Node* stack = m_head.exchange(nullptr, std::memory_order_acquire);
+
+		Node* fifo = nullptr;
+		while (stack) {
+			Node* next = stack->next;
+			stack->next = fifo;
+			fifo = stack;
+			stack = next;
+		}
+
+		size_t count = 0;
+		while (fifo) {
+			Node* next = fifo->next;
+			handler(std::move(fifo->value));
+			delete fifo;
+			fifo = next;
+			++count;
+		}
+		return count;
+	}
+
+	bool empty() const { return m_head.load(std::memory_order_acquire) == nullptr; }
+
+private:
+	struct Node {
+		T value;
+		Node* next;
+	};
+
+	std::atomic<Node*> m_head{ nullptr };
+};
@@ -1,9 +1,10 @@
 #include "DataManager.h"
 #include <fstream>
-#include <iostream>
 #include <algorithm>
 #include <cctype>
 #include <sstream>
+#include <cstdio>
+#include <chrono>
 
 #ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN
@@ -16,7 +17,25 @@
 #include <cstdlib>
 #endif
 
-#include "Aras.h"
+#include "AtomicFile.h"
+#include "Logger.h"
+#include "Tracer.h"
+#include "Metrics.h"
+
+constexpr const char* DEFAULT_METAR_HOST = "https://avwx.rest";
+constexpr int DEFAULT_FETCH_CONCURRENCY = 4;
+constexpr int MAX_FETCH_CONCURRENCY = 32;
+constexpr int DEFAULT_METAR_BATCH_SIZE = 25;
+constexpr int DEFAULT_AUTO_REFRESH_INTERVAL = static_cast<int>(MetarCache::issuanceInterval.count());
+constexpr int DEFAULT_AUTO_REFRESH_OFFSET = static_cast<int>(MetarCache::publicationDelay.count());
+#ifdef _WIN32
+constexpr const char* RWY_LINE_END = "\r\n"; // what the text mode stream used to write
+#else
+constexpr const char* RWY_LINE_END = "\n";
+#endif
+constexpr const char* WIND_SNAPSHOT_FILE = "windsnapshot.json";
+constexpr int WIND_SNAPSHOT_VERSION = 1;
+constexpr const char* TRACE_DIRECTORY = "traces";
 
 static std::string trim(const std::string& s) {
 	auto start = s.begin();
@@ -26,18 +45,44 @@ static std::string trim(const std::string& s) {
 	return std::string(start, end + 1);
 }
 
+// "2025-01-15T14:30:00Z" or "2025-01-15T14:30:00+00:00", always UTC for METARs
+static bool parseIsoTime(const std::string& text, std::chrono::system_clock::time_point& timePoint) {
+	int year = 0, month = 0, day = 0, hour = 0, minute = 0, second = 0;
+	if (std::sscanf(text.c_str(), "%d-%d-%dT%d:%d:%d", &year, &month, &day, &hour, &minute, &second) < 5) {
+		return false;
+	}
+	std::chrono::year_month_day date{ std::chrono::year{ year }, std::chrono::month{ static_cast<unsigned>(month) }, std::chrono::day{ static_cast<unsigned>(day) } };
+	if (!date.ok()) {
+		return false;
+	}
+	timePoint = std::chrono::sys_days{ date } + std::chrono::hours{ hour } + std::chrono::minutes{ minute } + std::chrono::seconds{ second };
+	return true;
+}
+
 
-DataManager::DataManager()
+DataManager::DataManager(const std::filesystem::path& configPath)
 {
-	m_configPath = getConfigPath();
+	m_configPath = configPath.empty() ? getConfigPath() : configPath;
+	m_configWriter = std::make_unique<DeferredWriter>(m_configPath / "config.json", [this]() { return serializeConfig(); });
 	if (!parseConfigFile()) {
 		createDefaultConfig();
 	}
+
+	// One connection per worker, more would never be used at the same time
+	int concurrency = std::clamp(getConfig()->value("fetchConcurrency", DEFAULT_FETCH_CONCURRENCY), 1, MAX_FETCH_CONCURRENCY);
+	// "metarHost" points the requests at a local mock of the AVWX API (aras-gen serve)
+	std::string metarHost = getConfig()->value("metarHost", std::string(DEFAULT_METAR_HOST));
+	m_metarClients = std::make_unique<HttpClientPool>(metarHost, static_cast<size_t>(concurrency));
+	m_fetchWorkers = std::make_unique<WorkerPool>(static_cast<size_t>(concurrency), "METAR fetch");
+
+	loadWindSnapshot();
 }
 
 DataManager::~DataManager()
 {
-	outputConfig();
+	m_fetchWorkers.reset(); // let pending fetches finish before the config is written
+	saveWindSnapshot();
+	m_configWriter->flush();
 }
 
 std::filesystem::path DataManager::getConfigPath()
@@ -66,36 +111,45 @@ bool DataManager::parseConfigFile()
 {
 	std::ifstream configFile(m_configPath / "config.json");
 	if (!configFile.is_open()) {
-		std::cout << "Failed to open config file." << std::endl;
+		LOG_WARNING << "Failed to open config file.";
 		return false;
 	}
 	try {
-		configFile >> m_configJson;
+		nlohmann::json configJson;
+		configFile >> configJson;
 		configFile.close();
-		m_token = m_configJson.value("apitoken", "");
-		if (m_configJson.contains("outputPath")) {
-			if (!m_configJson["outputPath"].get<std::string>().empty()) {
-				m_rwyFilePath = m_configJson["outputPath"].get<std::filesystem::path>();
-			}
-		}
+		updateConfig([&configJson](nlohmann::json& config) {
+			config = std::move(configJson);
+			return true;
+		}, false);
 	}
 	catch (const std::exception& e) {
-		std::cout << "Error parsing config file: " << e.what() << std::endl;
+		LOG_ERROR << "Error parsing config file: " << e.what();
 		return false;
 	}
+	return loadRunwayData();
+}
 
+bool DataManager::loadRunwayData()
+{
 	std::ifstream rwyDataFile(m_configPath / "rwydata.json");
 	if (!rwyDataFile.is_open()) {
-		std::cout << "Failed to open rwyData file." << std::endl;
+		LOG_WARNING << "Failed to open rwyData file.";
 		return false;
 	}
 	try {
-		rwyDataFile >> m_rwyDataJson;
+		nlohmann::json rwyDataJson;
+		rwyDataFile >> rwyDataJson;
 		rwyDataFile.close();
+		auto runwayIndex = std::make_shared<RunwayIndex>();
+		if (!runwayIndex->build(rwyDataJson)) {
+			return false;
+		}
+		m_runwayIndex.store(std::move(runwayIndex));
 		return true;
 	}
 	catch (const std::exception& e) {
-		std::cout << "Error parsing rwyData file: " << e.what() << std::endl;
+		LOG_ERROR << "Error parsing rwyData file: " << e.what();
 		return false;
 	}
 }
@@ -105,78 +159,168 @@ void DataManager::createDefaultConfig()
 	if (!std::filesystem::exists(m_configPath)) {
 		std::filesystem::create_directories(m_configPath);
 	}
-	m_configJson = {
-		{"apitoken", ""},
-		{"tokenValidity", false},
-		{"outputPath", ""},
-		{"FIR", {}}
-	};
+	updateConfig([](nlohmann::json& config) {
+		config = {
+			{"apitoken", ""},
+			{"tokenValidity", false},
+			{"outputPath", ""},
+			{"fetchConcurrency", DEFAULT_FETCH_CONCURRENCY},
+			{"metarBatchSize", DEFAULT_METAR_BATCH_SIZE},
+			{"autoRefreshInterval", DEFAULT_AUTO_REFRESH_INTERVAL},
+			{"autoRefreshOffset", DEFAULT_AUTO_REFRESH_OFFSET},
+			{"traceRuns", false},
+			{"metricsPort", 0},
+			{"metarHost", DEFAULT_METAR_HOST},
+			{"FIR", {}}
+		};
+		return true;
+	}, false);
 	if (outputConfig()) {
-		std::cout << "Default config created successfully." << std::endl;
+		LOG_INFO << "Default config created successfully.";
 	} else {
-		std::cout << "Failed to create default config." << std::endl;
+		LOG_ERROR << "Failed to create default config.";
 	}
 }
 
 bool DataManager::outputConfig()
 {
-	std::ofstream configFile(m_configPath / "config.json");
-	if (!configFile.is_open()) {
-		std::cout << "Failed to open config file for writing." << std::endl;
-		return false;
-	}
-	try {
-		configFile << m_configJson.dump(4);
-		configFile.close();
-		std::cout << "Config file written successfully." << std::endl;
-		return true;
-	}
-	catch (const std::exception& e) {
-		std::cout << "Error writing config file: " << e.what() << std::endl;
-	}
-	return false;
+	m_configWriter->markDirty();
+	return m_configWriter->flush();
 }
 
-bool DataManager::outputRunways(const std::vector<std::string> runways)
+void DataManager::saveConfig()
 {
-	if (m_configJson.contains("outputPath")) {
-		if (!m_configJson["outputPath"].is_null()) {
-			m_rwyFilePath = m_configJson["outputPath"].get<std::filesystem::path>();
-		}
-		else {
-			std::cout << "Output path not set" << std::endl;
-			return false;
+	m_configWriter->markDirty();
+}
+
+std::string DataManager::serializeConfig() const
+{
+	return getConfig()->dump(4);
+}
+
+void DataManager::updateConfig(const ConfigEdit& edit, bool save)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_configMutex);
+		nlohmann::json config = *getConfig();
+		if (!edit(config)) {
+			return;
 		}
+		m_config.store(std::make_shared<const nlohmann::json>(std::move(config)));
 	}
-	std::ofstream rwyFile(m_rwyFilePath);
-	if (!rwyFile.is_open()) {
-		std::cout << "Failed to open runway file for writing." << std::endl;
-		return false;
+	if (save) {
+		saveConfig();
+	}
+}
+
+bool DataManager::loadWindSnapshot()
+{
+	std::ifstream snapshotFile(m_configPath / WIND_SNAPSHOT_FILE);
+	if (!snapshotFile.is_open()) {
+		return false; // first launch, nothing saved yet
 	}
 	try {
-		for (const auto& runway : runways) {
-			if (runway.empty()) {
-				std::cout << "Empty runway name found, skipping." << std::endl;
+		nlohmann::json snapshotJson;
+		snapshotFile >> snapshotJson;
+		snapshotFile.close();
+		if (snapshotJson.value("version", 0) != WIND_SNAPSHOT_VERSION) {
+			LOG_WARNING << "Ignoring wind snapshot with unknown version.";
+			return false;
+		}
+
+		// "ICAO": [direction, speed, gust, observed, fetched], times in seconds since epoch
+		size_t restored = 0;
+		for (const auto& [oaci, values] : snapshotJson["airports"].items()) {
+			if (!values.is_array() || values.size() != 5) {
 				continue;
 			}
-			rwyFile << runway + "\n";
+			WindData windData{ values[0].get<int>(), values[1].get<int>(), values[2].get<int>() };
+			std::chrono::system_clock::time_point observed{ std::chrono::seconds{ values[3].get<long long>() } };
+			std::chrono::system_clock::time_point fetched{ std::chrono::seconds{ values[4].get<long long>() } };
+			m_metarCache.store(oaci, windData, observed, fetched);
+			++restored;
 		}
-		rwyFile.close();
-		std::cout << "Runway file written successfully." << std::endl;
+		m_metarCache.markSaved(m_metarCache.getVersion());
+		m_windSnapshotRestored = restored > 0;
+		LOG_INFO << "Wind snapshot loaded: " << restored << " airports.";
 		return true;
 	}
 	catch (const std::exception& e) {
-		std::cout << "Error writing runway file: " << e.what() << std::endl;
+		LOG_WARNING << "Error parsing wind snapshot: " << e.what();
 		return false;
 	}
 }
 
-void DataManager::updateAirportsConfig(const std::string& fir, std::string airports)
+bool DataManager::saveWindSnapshot()
 {
-	if (!m_configJson["FIR"].contains(fir)) {
-		return;
+	if (!m_metarCache.isDirty()) {
+		return true;
 	}
-	nlohmann::json& firAirports = m_configJson["FIR"][fir];
+	// Read before the entries, a wind stored meanwhile keeps the snapshot dirty
+	uint64_t version = m_metarCache.getVersion();
+
+	nlohmann::json airportsJson = nlohmann::json::object();
+	for (const auto& [oaci, entry] : m_metarCache.getEntries()) {
+		airportsJson[oaci] = {
+			entry.windData.windDirection,
+			entry.windData.windSpeed,
+			entry.windData.windGust,
+			std::chrono::duration_cast<std::chrono::seconds>(entry.observed.time_since_epoch()).count(),
+			std::chrono::duration_cast<std::chrono::seconds>(entry.fetched.time_since_epoch()).count()
+		};
+	}
+	nlohmann::json snapshotJson = { {"version", WIND_SNAPSHOT_VERSION}, {"airports", airportsJson} };
+
+	if (!AtomicFile::write(m_configPath / WIND_SNAPSHOT_FILE, snapshotJson.dump())) {
+		LOG_ERROR << "Failed to write wind snapshot, retrying after the next assignment.";
+		return false;
+	}
+	m_metarCache.markSaved(version);
+	return true;
+}
+
+DataManager::RwyWrite DataManager::outputRunways(const std::vector<std::string>& runways)
+{
+	TRACE_SCOPE("outputRunways");
+	std::filesystem::path rwyFilePath = getRwyFilePath();
+	if (rwyFilePath.empty()) {
+		LOG_WARNING << "Output path not set";
+		Metrics::instance().rwyFailed.add();
+		return RwyWrite::Failed;
+	}
+
+	size_t size = 0;
+	for (const auto& runway : runways) {
+		size += runway.size() + std::char_traits<char>::length(RWY_LINE_END);
+	}
+	std::string content;
+	content.reserve(size);
+	for (const auto& runway : runways) {
+		if (runway.empty()) {
+			LOG_WARNING << "Empty runway name found, skipping.";
+			continue;
+		}
+		content.append(runway).append(RWY_LINE_END);
+	}
+
+	// EuroScope only needs to see the file change when the runways do
+	if (AtomicFile::hasContent(rwyFilePath, content)) {
+		LOG_INFO << "Runway file already up to date.";
+		Metrics::instance().rwySkipped.add();
+		return RwyWrite::Skipped;
+	}
+	if (!AtomicFile::write(rwyFilePath, content)) {
+		LOG_ERROR << "Failed to open runway file for writing.";
+		Metrics::instance().rwyFailed.add();
+		return RwyWrite::Failed;
+	}
+	LOG_INFO << "Runway file written successfully.";
+	Metrics::instance().rwyWritten.add();
+	return RwyWrite::Written;
+}
+
+void DataManager::updateAirportsConfig(const std::string& fir, std::string airports)
+{
 	std::vector<std::string> newAirports;
 
 	std::istringstream ss(airports);
@@ -189,10 +333,13 @@ void DataManager::updateAirportsConfig(const std::string& fir, std::string airpo
 		}
 	}
 
-	firAirports = newAirports;
-	if (!outputConfig()) {
-		std::cout << "Failed to update airports in config file." << std::endl;
-	}
+	updateConfig([&fir, &newAirports](nlohmann::json& config) {
+		if (!config["FIR"].contains(fir)) {
+			return false;
+		}
+		config["FIR"][fir] = std::move(newAirports);
+		return true;
+	});
 }
 
 void DataManager::updateToken(const std::string& token)
@@ -200,46 +347,67 @@ void DataManager::updateToken(const std::string& token)
 	if (token.empty()) {
 		return;
 	}
-	m_token = token;
-	m_configJson["apitoken"] = m_token;
-	m_configJson["tokenValidity"] = false;
-	if (!outputConfig()) {
-		std::cout << "Failed to update token in config file." << std::endl;
-	}
+	updateConfig([&token](nlohmann::json& config) {
+		config["apitoken"] = token;
+		config["tokenValidity"] = false;
+		return true;
+	});
 }
 
 void DataManager::updateRwyLocation(const std::filesystem::path& path)
 {
 	if (path.empty() || !std::filesystem::exists(path)) {
-		std::cout << "Invalid runway location path." << std::endl;
+		LOG_WARNING << "Invalid runway location path.";
 		return;
 	}
-	m_rwyFilePath = path;
-	m_configJson["outputPath"] = m_rwyFilePath.string();
-	if (!outputConfig()) {
-		std::cout << "Failed to update runway location in config file." << std::endl;
-	}
+	updateConfig([&path](nlohmann::json& config) {
+		config["outputPath"] = path.string();
+		return true;
+	});
 }
 
 void DataManager::addFIRconfig(const std::string& fir)
 {
-	if (fir.empty() || m_configJson["FIR"].contains(fir)) {
-		return;
-	}
-	std::string firUpper = trim(fir);
-	m_configJson["FIR"][firUpper] = nlohmann::json::array();
-	m_configJson["FIR"][firUpper + "def"] = nlohmann::json::array();
+	updateConfig([&fir](nlohmann::json& config) {
+		if (fir.empty() || config["FIR"].contains(fir)) {
+			return false;
+		}
+		std::string firUpper = trim(fir);
+		config["FIR"][firUpper] = nlohmann::json::array();
+		config["FIR"][firUpper + "def"] = nlohmann::json::array();
+		return true;
+	});
+}
+
+std::string DataManager::getToken() const
+{
+	return getConfig()->value("apitoken", "");
+}
+
+bool DataManager::isTokenValid() const
+{
+	return getConfig()->value("tokenValidity", false);
+}
 
-	if (!outputConfig()) {
-		std::cout << "Failed to add FIR configuration." << std::endl;
+std::filesystem::path DataManager::getRwyFilePath() const
+{
+	if (!m_rwyFileOverride.empty()) {
+		return m_rwyFileOverride;
+	}
+	ConfigSnapshot config = getConfig();
+	auto outputPath = config->find("outputPath");
+	if (outputPath == config->end() || !outputPath->is_string()) {
+		return std::filesystem::path();
 	}
+	return outputPath->get<std::filesystem::path>();
 }
 
 std::vector<std::string> DataManager::getAirportsList(const std::string& fir) const
 {
-	if (!m_configJson.contains("FIR")) return std::vector<std::string>();
+	ConfigSnapshot config = getConfig();
+	if (!config->contains("FIR")) return std::vector<std::string>();
 	
-	const nlohmann::json& firs = m_configJson["FIR"];
+	const nlohmann::json& firs = (*config)["FIR"];
 	
 	if (firs.contains(fir)) {
 		std::vector<std::string> airports;
@@ -261,8 +429,9 @@ std::vector<std::string> DataManager::getDefaultAirportsList(const std::string&
 std::vector<std::string> DataManager::getFIRs() const
 {
 	std::vector<std::string> firs;
-	if (m_configJson.contains("FIR") && m_configJson["FIR"].is_object()) {
-		for (auto it = m_configJson["FIR"].begin(); it != m_configJson["FIR"].end(); ++it) {
+	ConfigSnapshot config = getConfig();
+	if (config->contains("FIR") && (*config)["FIR"].is_object()) {
+		for (auto it = (*config)["FIR"].begin(); it != (*config)["FIR"].end(); ++it) {
 			if (it.key().substr(it.key().size() - 3) == "def") {
 				continue;
 			}
@@ -272,85 +441,332 @@ std::vector<std::string> DataManager::getFIRs() const
 	return firs;
 }
 
+std::chrono::minutes DataManager::getAutoRefreshInterval() const
+{
+	return std::chrono::minutes{ std::max(getConfig()->value("autoRefreshInterval", DEFAULT_AUTO_REFRESH_INTERVAL), 1) };
+}
+
+std::chrono::minutes DataManager::getAutoRefreshOffset() const
+{
+	return std::chrono::minutes{ getConfig()->value("autoRefreshOffset", DEFAULT_AUTO_REFRESH_OFFSET) };
+}
+
+std::filesystem::path DataManager::getTraceDirectory() const
+{
+	if (!m_traceDirectoryOverride.empty()) {
+		return m_traceDirectoryOverride;
+	}
+	return getConfig()->value("traceRuns", false) ? m_configPath / TRACE_DIRECTORY : std::filesystem::path();
+}
+
+int DataManager::getMetricsPort() const
+{
+	return std::clamp(getConfig()->value("metricsPort", 0), 0, 65535);
+}
+
 std::future<WindData> DataManager::getWindData(const std::string& oaci)
 {
-	return std::async(std::launch::async, [this, oaci]() {
-		httplib::Client cli("https://avwx.rest");
-		httplib::Headers headers = {
-			{"Authorization", "BEARER " + m_token}
-		};
-		std::string apiEndpoint = "/api/metar/"; // Example endpoint
-		auto res = cli.Get(apiEndpoint + oaci, headers);
-		if (res) {
-			if (res->status == 200) {
-				if (!m_configJson["tokenValidity"].get<bool>()) {
-					m_configJson["tokenValidity"] = true;
-					if (!outputConfig()) {
-						std::cerr << "Failed to update token validity in config file." << std::endl;
-					}
-				}
+	WindData cached{};
+	if (m_metarCache.lookup(oaci, cached)) {
+		std::promise<WindData> ready;
+		ready.set_value(cached);
+		return ready.get_future();
+	}
+	return m_fetchWorkers->submit([this, oaci]() {
+		return fetchWindData(oaci);
+	});
+}
 
-				nlohmann::json responseJson;
-				try {
-					WindData windData{};
-					responseJson = nlohmann::json::parse(res->body);
-					windData.windDirection = responseJson["wind_direction"]["value"].is_null() ? 0 : responseJson["wind_direction"]["value"].get<int>();
-					windData.windSpeed = responseJson["wind_speed"].value("value", 0);
-					windData.windGust = responseJson["wind_gust"].is_null() ? 0 : responseJson["wind_gust"].value("value", 0);
+std::vector<std::future<WindData>> DataManager::getWindData(const std::vector<std::string>& airports, const WindDataCallback& onReady)
+{
+	TRACE_SCOPE("getWindData");
+	std::vector<std::future<WindData>> windDataFutures;
+	size_t batchSize = static_cast<size_t>(std::max(getConfig()->value("metarBatchSize", DEFAULT_METAR_BATCH_SIZE), 1));
+	if (!isBatchFetchSupported()) {
+		batchSize = 1;
+	}
+	auto callback = onReady ? std::make_shared<WindDataCallback>(onReady) : nullptr;
 
-					return windData;
-				}
-				catch (const std::exception& e) {
-					std::cerr << "Error when parsing response: " << e.what() << std::endl;
-				}
+	// Every airport gets its own promise, a station listed twice is only requested once
+	std::vector<PendingWindData> chunk;
+	for (size_t i = 0; i < airports.size(); ++i) {
+		const std::string& airport = airports[i];
+		if (airport.empty()) {
+			continue;
+		}
+		WindDataWaiter waiter{ std::make_shared<std::promise<WindData>>(), i, callback };
+		windDataFutures.push_back(waiter.promise->get_future());
+
+		WindData cached{};
+		if (m_metarCache.lookup(airport, cached)) {
+			resolveWindData(waiter, cached);
+			continue;
+		}
+
+		auto existing = std::find_if(chunk.begin(), chunk.end(), [&](const PendingWindData& pending) { return pending.oaci == airport; });
+		if (existing != chunk.end()) {
+			existing->waiters.push_back(std::move(waiter));
+			continue;
+		}
+		chunk.push_back({ airport, { std::move(waiter) } });
+		if (chunk.size() == batchSize) {
+			submitBatch(std::move(chunk));
+			chunk.clear();
+		}
+	}
+	if (!chunk.empty()) {
+		submitBatch(std::move(chunk));
+	}
+	return windDataFutures;
+}
+
+void DataManager::submitBatch(std::vector<PendingWindData> chunk)
+{
+	auto sharedChunk = std::make_shared<std::vector<PendingWindData>>(std::move(chunk));
+	m_fetchWorkers->submit([this, sharedChunk]() {
+		std::unordered_map<std::string, WindData> results;
+		if (sharedChunk->size() > 1 && isBatchFetchSupported()) {
+			std::vector<std::string> stations;
+			stations.reserve(sharedChunk->size());
+			for (const auto& pending : *sharedChunk) {
+				stations.push_back(pending.oaci);
+			}
+			if (fetchWindDataBatch(stations, results) == BatchFetch::BadRequest) {
+				// Halves until the rejected station is requested on its own
+				auto middle = sharedChunk->begin() + static_cast<std::ptrdiff_t>(sharedChunk->size() / 2);
+				submitBatch(std::vector<PendingWindData>(sharedChunk->begin(), middle));
+				submitBatch(std::vector<PendingWindData>(middle, sharedChunk->end()));
+				return;
 			}
 		}
-		return WindData{ -1, -1, -1 }; // Return invalid values if request fails
+
+		for (auto& pending : *sharedChunk) {
+			auto it = results.find(pending.oaci);
+			if (it != results.end()) {
+				resolveWindData(pending, it->second);
+				continue;
+			}
+			if (sharedChunk->size() == 1) {
+				resolveWindData(pending, fetchWindData(pending.oaci));
+				continue;
+			}
+			// Missing from the batch response, fall back to a single request on another worker
+			m_fetchWorkers->submit([this, pending]() {
+				resolveWindData(pending, fetchWindData(pending.oaci));
+			});
+		}
 	});
 }
 
-std::vector<std::future<WindData>> DataManager::getWindData(const std::vector<std::string>& airports)
+void DataManager::resolveWindData(const PendingWindData& pending, const WindData& windData)
 {
-	std::vector<std::future<WindData>> windDataFutures;
-	for (const auto& airport : airports) {
-		if (!airport.empty()) {
-			windDataFutures.push_back(getWindData(airport));
+	for (const auto& waiter : pending.waiters) {
+		resolveWindData(waiter, windData);
+	}
+}
+
+void DataManager::resolveWindData(const WindDataWaiter& waiter, const WindData& windData)
+{
+	waiter.promise->set_value(windData);
+	if (waiter.onReady) {
+		(*waiter.onReady)(waiter.index, windData);
+	}
+}
+
+DataManager::BatchFetch DataManager::fetchWindDataBatch(const std::vector<std::string>& stations, std::unordered_map<std::string, WindData>& results)
+{
+	std::string token = getToken();
+	httplib::Headers headers = {
+		{"Authorization", "BEARER " + token}
+	};
+	std::string apiEndpoint = "/api/multi/metar/";
+	for (size_t i = 0; i < stations.size(); ++i) {
+		if (i > 0) apiEndpoint += ",";
+		apiEndpoint += stations[i];
+	}
+	TRACE_SCOPE("fetchWindDataBatch", std::to_string(stations.size()) + " stations");
+
+	auto requestStart = std::chrono::steady_clock::now();
+	auto res = m_metarClients->get(apiEndpoint, headers);
+	double requestSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - requestStart).count();
+	if (!res) {
+		LOG_ERROR << "Batch METAR request failed: " << httplib::to_string(res.error());
+		return BatchFetch::Failed;
+	}
+	if (res->status == 400) {
+		LOG_WARNING << "Batch METAR request rejected (HTTP 400), splitting " << stations.size() << " stations.";
+		return BatchFetch::BadRequest;
+	}
+	std::string body = res->body;
+	std::transform(body.begin(), body.end(), body.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+	// Multi-station lookups are not available on every AVWX plan, a 403 without a word
+	// about the plan is a token problem that the single requests will report
+	if (res->status == 404 || (res->status == 403 && body.find("plan") != std::string::npos)) {
+		{
+			std::lock_guard<std::mutex> lock(m_batchRefusalMutex);
+			m_batchRefusedToken = token;
+			m_batchRefusedAt = std::chrono::system_clock::now();
 		}
+		LOG_WARNING << "Batch METAR endpoint unavailable (HTTP " << res->status << "), using per-airport requests.";
+		return BatchFetch::Failed;
 	}
-	return windDataFutures;
+	if (res->status != 200) {
+		LOG_ERROR << "Batch METAR request failed with status " << res->status;
+		return BatchFetch::Failed;
+	}
+	markTokenValid();
+
+	try {
+		TRACE_SCOPE("parse METAR", "batch");
+		nlohmann::json responseJson = nlohmann::json::parse(res->body);
+		if (!responseJson.is_array()) {
+			return BatchFetch::Failed;
+		}
+		for (const auto& metar : responseJson) {
+			if (!metar.is_object() || !metar.contains("station") || !metar["station"].is_string()) {
+				continue;
+			}
+			WindData windData{};
+			std::chrono::system_clock::time_point observed{};
+			if (parseWindData(metar, windData, observed)) {
+				std::string station = metar["station"].get<std::string>();
+				completeWindData(station, windData, observed);
+				Metrics::instance().observeMetarFetch(station, requestSeconds);
+				results[station] = windData;
+			}
+		}
+		return BatchFetch::Done;
+	}
+	catch (const std::exception& e) {
+		LOG_ERROR << "Error when parsing batch response: " << e.what();
+	}
+	return BatchFetch::Failed;
 }
 
-std::vector<RunwayData> DataManager::getAirportRunwaysData(const std::string& airport)
+bool DataManager::isBatchFetchSupported() const
 {
-	std::vector<RunwayData> runwaysData;
-	RunwayData runwayData;
-	runwayData.airport = airport;
+	std::lock_guard<std::mutex> lock(m_batchRefusalMutex);
+	if (m_batchRefusedToken.empty()) {
+		return true;
+	}
+	return m_batchRefusedToken != getToken() || std::chrono::system_clock::now() - m_batchRefusedAt >= MetarCache::issuanceInterval;
+}
+
+WindData DataManager::fetchWindData(const std::string& oaci)
+{
+	TRACE_SCOPE("fetchWindData", oaci);
+	httplib::Headers headers = {
+		{"Authorization", "BEARER " + getToken()}
+	};
+	std::string apiEndpoint = "/api/metar/"; // Example endpoint
+	auto requestStart = std::chrono::steady_clock::now();
+	auto res = m_metarClients->get(apiEndpoint + oaci, headers);
+	double requestSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - requestStart).count();
+	if (res) {
+		if (res->status == 200) {
+			markTokenValid();
 
-	if (m_rwyDataJson[airport].contains("has4runways")) {
-		runwayData.has4rwys = true;
+			try {
+				TRACE_SCOPE("parse METAR", oaci);
+				WindData windData{};
+				std::chrono::system_clock::time_point observed{};
+				if (parseWindData(nlohmann::json::parse(res->body), windData, observed)) {
+					completeWindData(oaci, windData, observed);
+					Metrics::instance().observeMetarFetch(oaci, requestSeconds);
+					return windData;
+				}
+			}
+			catch (const std::exception& e) {
+				LOG_ERROR << "Error when parsing response: " << e.what();
+			}
+		}
 	}
 
-	auto iterator = m_rwyDataJson[airport]["runways"].begin();
-	while (iterator != m_rwyDataJson[airport]["runways"].end()) {
-		std::string variant = iterator.key();
-		nlohmann::json rwydataJson = m_rwyDataJson[airport]["runways"][variant];
+	MetarCache::Entry lastKnown;
+	if (m_metarCache.lookupStale(oaci, lastKnown)) {
+		auto reference = lastKnown.observed != std::chrono::system_clock::time_point{} ? lastKnown.observed : lastKnown.fetched;
+		auto age = std::chrono::duration_cast<std::chrono::minutes>(std::chrono::system_clock::now() - reference);
+		LOG_WARNING << "[STALE] Could not fetch METAR for " << oaci << ", using last known wind observed " << age.count() << " min ago.";
+		Metrics::instance().staleWinds.add();
+		WindData windData = lastKnown.windData;
+		windData.stale = true;
+		return windData;
+	}
+	return WindData{ -1, -1, -1 }; // Return invalid values if request fails
+}
 
-		runwayData.depRunway = rwydataJson["departure"];
-		runwayData.arrRunway = rwydataJson["arrival"];
-		runwayData.heading = rwydataJson["heading"];
-		runwayData.preferential = rwydataJson["preferential"];
-		if (runwayData.has4rwys) {
-			runwayData.depRunwayBis = rwydataJson["departureBis"];
-			runwayData.arrRunwayBis = rwydataJson["arrivalBis"];
+bool DataManager::getLastKnownWind(const std::string& oaci, WindData& windData) const
+{
+	MetarCache::Entry lastKnown;
+	if (!m_metarCache.lookupStale(oaci, lastKnown)) {
+		return false;
+	}
+	windData = lastKnown.windData;
+	windData.stale = true;
+	return true;
+}
+
+void DataManager::completeWindData(const std::string& oaci, const WindData& windData, std::chrono::system_clock::time_point observed)
+{
+	m_metarCache.store(oaci, windData, observed);
+}
+
+bool DataManager::parseWindData(const nlohmann::json& metar, WindData& windData, std::chrono::system_clock::time_point& observed)
+{
+	if (!metar.is_object() || !metar.contains("wind_speed")) {
+		return false;
+	}
+	// Missing or null values (calm, VRB, no gust) read as 0
+	auto readValue = [&metar](const char* key) {
+		auto field = metar.find(key);
+		if (field == metar.end() || !field->is_object()) return 0;
+		auto value = field->find("value");
+		if (value == field->end() || !value->is_number()) return 0;
+		return value->get<int>();
+	};
+	windData.windDirection = readValue("wind_direction");
+	windData.windSpeed = readValue("wind_speed");
+	windData.windGust = readValue("wind_gust");
+
+	observed = {};
+	auto time = metar.find("time");
+	if (time != metar.end() && time->is_object()) {
+		auto dt = time->find("dt");
+		if (dt != time->end() && dt->is_string()) {
+			parseIsoTime(dt->get<std::string>(), observed);
 		}
-		else {
-			runwayData.depRunwayBis = "";
-			runwayData.arrRunwayBis = "";
+	}
+	return true;
+}
+
+void DataManager::markTokenValid()
+{
+	if (isTokenValid()) {
+		return;
+	}
+	updateConfig([](nlohmann::json& config) {
+		if (config.value("tokenValidity", false)) {
+			return false; // another worker was first
 		}
-		runwaysData.push_back(runwayData);
-		
-		++iterator;
+		config["tokenValidity"] = true;
+		return true;
+	});
+}
+
+std::vector<RunwayData> DataManager::getAirportRunwaysData(const std::string& airport) const
+{
+	TRACE_SCOPE("getAirportRunwaysData", airport);
+	std::vector<RunwayData> runwaysData;
+	std::shared_ptr<const RunwayIndex> runwayIndex = getRunwayIndex();
+	const AirportRunways* airportRunways = runwayIndex->find(airport);
+	if (airportRunways == nullptr) {
+		return runwaysData;
 	}
 
+	std::span<const RunwayConfig> configs = runwayIndex->getConfigs(*airportRunways);
+	runwaysData.reserve(configs.size());
+	for (const RunwayConfig& config : configs) {
+		runwaysData.push_back(runwayIndex->toRunwayData(airport, *airportRunways, config));
+	}
 	return runwaysData;
 }
@@ -2,51 +2,133 @@
 #include <string>
 #include <filesystem>
 #include <future>
+#include <functional>
+#include <atomic>
+#include <unordered_map>
+#include <mutex>
+#include <memory>
 #include <nlohmann/json.hpp>
 
 #define CPPHTTPLIB_OPENSSL_SUPPORT
 #include <httplib.h>
 
-struct RunwayData;
+#include "WindData.h"
+#include "HttpClientPool.h"
+#include "WorkerPool.h"
+#include "MetarCache.h"
+#include "RunwayIndex.h"
+#include "DeferredWriter.h"
 
-struct WindData {
-	int windDirection;
-	int windSpeed;
-	int windGust;
-};
 
 class DataManager {
 public:
-	DataManager();
+	enum class RwyWrite {
+		Written,
+		Skipped, // the file already had this content
+		Failed
+	};
+
+	// Uses Documents/Aras when no configuration directory is given
+	explicit DataManager(const std::filesystem::path& configPath = {});
 	~DataManager();
 	
 	std::filesystem::path getConfigPath();
 	bool parseConfigFile();
+	// Builds a new runway index, assignments in progress keep the one they started with
+	bool loadRunwayData();
 	void createDefaultConfig();
-	bool outputConfig();
-	bool outputRunways(const std::vector<std::string> runways);
+	bool outputConfig(); // writes now, edits are otherwise saved in the background
+	bool loadWindSnapshot();
+	bool hasWindSnapshot() const { return m_windSnapshotRestored; } // the startup load restored airports
+	bool saveWindSnapshot();
+	RwyWrite outputRunways(const std::vector<std::string>& runways);
 
 	void updateAirportsConfig(const std::string& fir, std::string airports);
 	void updateToken(const std::string& token);
 	void updateRwyLocation(const std::filesystem::path& path);
 	void addFIRconfig(const std::string& fir);
+	void setRwyFileOverride(const std::filesystem::path& path) { m_rwyFileOverride = path; } // not saved to config.json
+	void setTraceDirectoryOverride(const std::filesystem::path& path) { m_traceDirectoryOverride = path; } // not saved to config.json
 
-	bool isTokenValid() const { return m_configJson.value("tokenValidity", false); }
+	// Configuration snapshots are never modified once published, edits replace them
+	using ConfigSnapshot = std::shared_ptr<const nlohmann::json>;
+	ConfigSnapshot getConfig() const { return m_config.load(); }
+	bool isTokenValid() const;
 
 	std::vector<std::string> getAirportsList(const std::string& fir) const;
 	std::vector<std::string> getDefaultAirportsList(const std::string& fir) const;
 	std::vector<std::string> getFIRs() const;
-	std::string getToken() const { return m_token; }
-	std::filesystem::path getRwyFilePath() const { return m_rwyFilePath; }
+	std::string getToken() const;
+	std::filesystem::path getRwyFilePath() const;
+	// Auto refresh runs every interval, offset from the hour (both in minutes of UTC time)
+	std::chrono::minutes getAutoRefreshInterval() const;
+	std::chrono::minutes getAutoRefreshOffset() const;
+	// Where each assignment writes its Chrome trace, empty when tracing is off ("traceRuns")
+	std::filesystem::path getTraceDirectory() const;
+	// Port of the local Prometheus endpoint, 0 when disabled ("metricsPort")
+	int getMetricsPort() const;
 	std::future<WindData> getWindData(const std::string& oaci);
-	std::vector<std::future<WindData>> getWindData(const std::vector<std::string>& airports);
-	std::vector<RunwayData> getAirportRunwaysData(const std::string& airport);
+	// onReady is called from the fetching thread as soon as an airport's wind is known,
+	// with the airport's position in the airports list
+	using WindDataCallback = std::function<void(size_t index, const WindData& windData)>;
+	std::vector<std::future<WindData>> getWindData(const std::vector<std::string>& airports, const WindDataCallback& onReady = nullptr);
+	// Snapshot or expired cache entry, flagged stale, without fetching
+	bool getLastKnownWind(const std::string& oaci, WindData& windData) const;
+	std::vector<RunwayData> getAirportRunwaysData(const std::string& airport) const;
+	std::shared_ptr<const RunwayIndex> getRunwayIndex() const { return m_runwayIndex.load(); }
+
+	HttpClientPool::Stats getFetchStats() const { return m_metarClients->getStats(); }
+	void resetFetchStats() { m_metarClients->resetStats(); m_metarCache.resetStats(); }
+	size_t getCacheHits() const { return m_metarCache.getHits(); }
 	
+private:
+	struct WindDataWaiter {
+		std::shared_ptr<std::promise<WindData>> promise;
+		size_t index = 0;
+		std::shared_ptr<WindDataCallback> onReady;
+	};
+	struct PendingWindData {
+		std::string oaci;
+		std::vector<WindDataWaiter> waiters;
+	};
+
+	void submitBatch(std::vector<PendingWindData> chunk);
+	static void resolveWindData(const PendingWindData& pending, const WindData& windData);
+	static void resolveWindData(const WindDataWaiter& waiter, const WindData& windData);
+	enum class BatchFetch {
+		Done,
+		Failed, // stations fall back to single requests
+		BadRequest // a station the API rejects, the chunk is split
+	};
+	BatchFetch fetchWindDataBatch(const std::vector<std::string>& stations, std::unordered_map<std::string, WindData>& results);
+	// False while the token's plan has refused multi-station lookups, tried again with
+	// another token or after an issuance interval
+	bool isBatchFetchSupported() const;
+	WindData fetchWindData(const std::string& oaci);
+	void completeWindData(const std::string& oaci, const WindData& windData, std::chrono::system_clock::time_point observed);
+	static bool parseWindData(const nlohmann::json& metar, WindData& windData, std::chrono::system_clock::time_point& observed);
+	void markTokenValid();
+	// Only way to change the configuration: edit returns false to leave it as is
+	using ConfigEdit = std::function<bool(nlohmann::json& config)>;
+	void updateConfig(const ConfigEdit& edit, bool save = true);
+	void saveConfig();
+	std::string serializeConfig() const;
+
 private:
 	std::filesystem::path m_configPath;
-	std::filesystem::path m_rwyFilePath;
+	std::filesystem::path m_rwyFileOverride;
+	std::filesystem::path m_traceDirectoryOverride;
+
+	std::mutex m_configMutex; // serializes updateConfig, readers only load the snapshot
+	std::atomic<ConfigSnapshot> m_config{ std::make_shared<const nlohmann::json>(nlohmann::json::object()) };
+	std::atomic<std::shared_ptr<const RunwayIndex>> m_runwayIndex{ std::make_shared<const RunwayIndex>() };
+	mutable std::mutex m_batchRefusalMutex;
+	std::string m_batchRefusedToken;
+	std::chrono::system_clock::time_point m_batchRefusedAt{};
+	MetarCache m_metarCache;
+	bool m_windSnapshotRestored = false;
+	std::unique_ptr<DeferredWriter> m_configWriter; // declared after the config it serializes
 
-	nlohmann::json m_configJson;
-	nlohmann::json m_rwyDataJson;
-	std::string m_token;
+	std::unique_ptr<HttpClientPool> m_metarClients;
+	std::unique_ptr<WorkerPool> m_fetchWorkers; // declared after the clients it uses
 };
\ No newline at end of file
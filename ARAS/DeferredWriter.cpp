@@ -0,0 +1,84 @@
+#include "DeferredWriter.h"
+
+#include "AtomicFile.h"
+#include "Logger.h"
+
+DeferredWriter::DeferredWriter(std::filesystem::path path, Serializer serializer, std::chrono::milliseconds delay)
+	: m_path(std::move(path)), m_serializer(std::move(serializer)), m_delay(delay)
+{
+	m_flusher = std::thread(&DeferredWriter::flusherLoop, this);
+}
+
+DeferredWriter::~DeferredWriter()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_wake.notify_all();
+	if (m_flusher.joinable()) {
+		m_flusher.join();
+	}
+	flush();
+}
+
+void DeferredWriter::markDirty()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_dirty = true;
+		m_lastChange = Clock::now();
+	}
+	m_wake.notify_all();
+}
+
+bool DeferredWriter::flush()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (!m_dirty) {
+			return true;
+		}
+		m_dirty = false;
+	}
+	return write();
+}
+
+bool DeferredWriter::isDirty() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_dirty;
+}
+
+void DeferredWriter::flusherLoop()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (!m_stop) {
+		if (!m_dirty) {
+			m_wake.wait(lock, [this] { return m_stop || m_dirty; });
+			continue;
+		}
+		// Every edit pushes the write back, wait for the burst to end
+		Clock::time_point due = m_lastChange + m_delay;
+		if (Clock::now() < due) {
+			m_wake.wait_until(lock, due, [this] { return m_stop; });
+			continue;
+		}
+		m_dirty = false;
+		lock.unlock();
+		write();
+		lock.lock();
+	}
+}
+
+bool DeferredWriter::write()
+{
+	std::lock_guard<std::mutex> lock(m_writeMutex);
+	std::string content = m_serializer();
+	if (!AtomicFile::write(m_path, content)) {
+		LOG_ERROR << "Failed to write " << m_path.filename().string() << ".";
+		return false;
+	}
+	LOG_INFO << m_path.filename().string() << " written successfully.";
+	return true;
+}
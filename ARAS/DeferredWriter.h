@@ -0,0 +1,46 @@
+#pragma once
+#include <string>
+#include <filesystem>
+#include <functional>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// Write-behind for a file rewritten on every edit. markDirty() only flags the
+// content, a background thread serializes and writes it atomically once no
+// edit came for the delay, so a burst of edits costs a single write.
+class DeferredWriter {
+public:
+	using Serializer = std::function<std::string()>;
+	using Clock = std::chrono::steady_clock;
+
+	DeferredWriter(std::filesystem::path path, Serializer serializer, std::chrono::milliseconds delay = std::chrono::milliseconds{ 500 });
+	~DeferredWriter(); // flushes pending changes
+
+	DeferredWriter(const DeferredWriter&) = delete;
+	DeferredWriter& operator=(const DeferredWriter&) = delete;
+
+	void markDirty();
+	// Writes now if anything changed since the last write
+	bool flush();
+	bool isDirty() const;
+
+private:
+	void flusherLoop();
+	bool write();
+
+private:
+	const std::filesystem::path m_path;
+	const Serializer m_serializer;
+	const std::chrono::milliseconds m_delay;
+
+	mutable std::mutex m_mutex;
+	std::condition_variable m_wake;
+	bool m_dirty = false;
+	bool m_stop = false;
+	Clock::time_point m_lastChange{};
+
+	std::mutex m_writeMutex; // flush() and the flusher may both write
+	std::thread m_flusher;
+};
@@ -0,0 +1,38 @@
+#pragma once
+#include <string>
+#include <memory>
+#include <atomic>
+#include <ctime>
+#include <cstdio>
+#include <cstdint>
+
+// Pieces shared by the Logger and the Tracer
+
+// thread_local owner of a per-thread buffer that a collector also lists.
+// Flags the buffer closed when its thread exits, the collector then drops it.
+struct ThreadBufferHolder {
+	std::shared_ptr<void> buffer;
+	std::atomic<bool>* closed = nullptr;
+
+	~ThreadBufferHolder()
+	{
+		if (closed) closed->store(true, std::memory_order_release);
+	}
+};
+
+// Appends the UTC time with strftime's format, then the milliseconds with the
+// printf format of an int
+inline void appendUtcTime(int64_t milliseconds, const char* format, const char* millisecondsFormat, std::string& out)
+{
+	std::time_t seconds = static_cast<std::time_t>(milliseconds / 1000);
+	std::tm utc{};
+#ifdef _WIN32
+	gmtime_s(&utc, &seconds);
+#else
+	gmtime_r(&seconds, &utc);
+#endif
+	char buffer[48];
+	size_t size = std::strftime(buffer, sizeof(buffer), format, &utc);
+	std::snprintf(buffer + size, sizeof(buffer) - size, millisecondsFormat, static_cast<int>(milliseconds % 1000));
+	out += buffer;
+}
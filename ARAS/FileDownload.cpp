@@ -0,0 +1,250 @@
+#include "FileDownload.h"
+#include <fstream>
+#include <system_error>
+#include <vector>
+#include <openssl/evp.h>
+
+#define CPPHTTPLIB_OPENSSL_SUPPORT
+#include <httplib.h>
+
+#include "Logger.h"
+
+namespace {
+
+// Incremental SHA-256 over the bytes of the file in download order
+class Sha256 {
+public:
+	Sha256() : m_context(EVP_MD_CTX_new()) { reset(); }
+	~Sha256() { EVP_MD_CTX_free(m_context); }
+
+	Sha256(const Sha256&) = delete;
+	Sha256& operator=(const Sha256&) = delete;
+
+	void reset() { EVP_DigestInit_ex(m_context, EVP_sha256(), nullptr); }
+	void update(const char* data, size_t size) { EVP_DigestUpdate(m_context, data, size); }
+
+	std::string hexDigest()
+	{
+		unsigned char digest[EVP_MAX_MD_SIZE];
+		unsigned int size = 0;
+		EVP_DigestFinal_ex(m_context, digest, &size);
+		static const char* hexDigits = "0123456789abcdef";
+		std::string hex;
+		hex.reserve(size * 2);
+		for (unsigned int i = 0; i < size; ++i) {
+			hex += hexDigits[digest[i] >> 4];
+			hex += hexDigits[digest[i] & 0xF];
+		}
+		return hex;
+	}
+
+private:
+	EVP_MD_CTX* m_context;
+};
+
+// "https://host/path" to "https://host" and "/path"
+bool splitUrl(const std::string& url, std::string& host, std::string& path)
+{
+	size_t scheme = url.find("://");
+	if (scheme == std::string::npos) return false;
+	size_t slash = url.find('/', scheme + 3);
+	host = url.substr(0, slash);
+	path = slash == std::string::npos ? "/" : url.substr(slash);
+	return true;
+}
+
+// First byte of "bytes first-last/size"
+bool parseContentRangeStart(const std::string& value, uint64_t& first)
+{
+	const std::string unit = "bytes ";
+	if (value.compare(0, unit.size(), unit) != 0) return false;
+	size_t dash = value.find('-', unit.size());
+	if (dash == std::string::npos || dash == unit.size()) return false;
+	first = 0;
+	for (size_t i = unit.size(); i < dash; ++i) {
+		if (value[i] < '0' || value[i] > '9') return false;
+		first = first * 10 + static_cast<uint64_t>(value[i] - '0');
+	}
+	return true;
+}
+
+} // namespace
+
+FileDownload::FileDownload(std::string url, std::filesystem::path target, std::string version, std::string expectedSha256)
+	: m_url(std::move(url)), m_target(std::move(target)), m_partial(m_target.string() + ".part"), m_partialInfo(m_partial.string() + ".info")
+	, m_version(std::move(version)), m_expectedSha256(std::move(expectedSha256))
+{
+}
+
+FileDownload::~FileDownload()
+{
+	if (m_thread.joinable()) {
+		m_thread.join();
+	}
+}
+
+void FileDownload::start()
+{
+	m_thread = std::thread(&FileDownload::run, this);
+}
+
+void FileDownload::run()
+{
+	bool success = false;
+	for (int i = 1; i <= maxAttempts && !success; ++i) {
+		success = attempt();
+		if (!success && i < maxAttempts) {
+			LOG_WARNING << "Retrying download of " << m_target.filename().string() << " (" << i << "/" << maxAttempts << ")";
+		}
+	}
+	m_success.store(success, std::memory_order_release);
+	m_done.store(true, std::memory_order_release);
+}
+
+bool FileDownload::attempt()
+{
+	std::string host, path;
+	if (!splitUrl(m_url, host, path)) {
+		LOG_ERROR << "No URL provided for download";
+		return false;
+	}
+
+	// Partial data of another release, or that the server cannot confirm unchanged, is never resumed
+	std::string validator = loadPartialValidator();
+	if (!validator.empty() && m_expectedSha256.empty()) {
+		// Without a digest nothing would catch a file spliced from two transfers, and the installer runs elevated
+		LOG_WARNING << "No checksum published for " << m_target.filename().string() << ", downloading it again from the start";
+		validator.clear();
+	}
+	if (validator.empty()) {
+		removePartial();
+	}
+
+	// Whatever a previous attempt left is hashed again before new bytes arrive
+	Sha256 sha256;
+	uint64_t resumeFrom = 0;
+	{
+		std::ifstream partial(m_partial, std::ios::binary);
+		std::vector<char> buffer(1 << 16);
+		while (partial.read(buffer.data(), buffer.size()) || partial.gcount() > 0) {
+			sha256.update(buffer.data(), static_cast<size_t>(partial.gcount()));
+			resumeFrom += static_cast<uint64_t>(partial.gcount());
+		}
+	}
+
+	std::ofstream out(m_partial, std::ios::binary | std::ios::app);
+	if (!out) {
+		LOG_ERROR << "Failed to open file for writing";
+		return false;
+	}
+	m_received = resumeFrom;
+
+	httplib::Client cli(host);
+	cli.set_follow_location(true);
+	cli.set_connection_timeout(10);
+	cli.set_read_timeout(30);
+	httplib::Headers headers = { {"User-Agent", "ARAS-Updater"} };
+	if (resumeFrom > 0) {
+		headers.emplace(httplib::make_range_header({ { static_cast<ssize_t>(resumeFrom), -1 } }));
+		headers.emplace("If-Range", validator);
+		LOG_INFO << "Resuming " << m_target.filename().string() << " from " << resumeFrom / 1024 << " KB";
+	}
+
+	bool restarted = false;
+	bool rangeMismatch = false;
+	auto res = cli.Get(path, headers,
+		[&](const httplib::Response& response) {
+			if (response.status != 200 && response.status != 206) {
+				return false;
+			}
+			uint64_t first = 0;
+			if (response.status == 206 && (!parseContentRangeStart(response.get_header_value("Content-Range"), first) || first != resumeFrom)) {
+				// The bytes would not continue the partial file
+				rangeMismatch = true;
+				return false;
+			}
+			if (resumeFrom > 0 && response.status == 200) {
+				// The server ignored the range or the file changed, start over
+				out.close();
+				out.open(m_partial, std::ios::binary | std::ios::trunc);
+				sha256.reset();
+				m_received = 0;
+				restarted = true;
+			}
+			// A weak ETag cannot be used in If-Range
+			std::string etag = response.get_header_value("ETag");
+			savePartialInfo(!etag.empty() && etag.rfind("W/", 0) != 0 ? etag : response.get_header_value("Last-Modified"));
+			return true;
+		},
+		[&](const char* data, size_t dataLength) {
+			out.write(data, static_cast<std::streamsize>(dataLength));
+			sha256.update(data, dataLength);
+			m_received.fetch_add(dataLength, std::memory_order_relaxed);
+			return static_cast<bool>(out);
+		},
+		[&](uint64_t, uint64_t total) {
+			if (total > 0) {
+				m_total.store((restarted ? 0 : resumeFrom) + total, std::memory_order_relaxed);
+			}
+			return true;
+		});
+	out.close();
+
+	if (rangeMismatch) {
+		LOG_WARNING << "Unexpected Content-Range resuming " << m_target.filename().string() << ", downloading it again from the start";
+		removePartial();
+		return false;
+	}
+	if (!res || (res->status != 200 && res->status != 206)) {
+		LOG_ERROR << "Download failed: " << (res ? std::to_string(res->status) : httplib::to_string(res.error()));
+		if (res && res->status == 416) {
+			removePartial(); // range past the end, the partial file is unusable
+		}
+		return false;
+	}
+
+	std::string digest = sha256.hexDigest();
+	if (!m_expectedSha256.empty() && digest != m_expectedSha256) {
+		LOG_ERROR << "Checksum mismatch for " << m_target.filename().string() << ", expected " << m_expectedSha256 << " got " << digest;
+		removePartial();
+		return false;
+	}
+
+	std::error_code error;
+	std::filesystem::rename(m_partial, m_target, error);
+	if (error) {
+		LOG_ERROR << "Failed to move " << m_partial.string() << ": " << error.message();
+		return false;
+	}
+	std::filesystem::remove(m_partialInfo, error);
+	LOG_INFO << "Download complete! " << m_target.filename().string() << " sha256 " << digest;
+	return true;
+}
+
+std::string FileDownload::loadPartialValidator() const
+{
+	// Release on the first line, validator on the second
+	std::ifstream info(m_partialInfo);
+	std::string version, validator;
+	if (!std::getline(info, version) || !std::getline(info, validator)) {
+		return std::string();
+	}
+	if (version != m_version) {
+		LOG_INFO << "Discarding the partial " << m_target.filename().string() << " of release " << version;
+		return std::string();
+	}
+	return validator;
+}
+
+void FileDownload::savePartialInfo(const std::string& validator) const
+{
+	std::ofstream info(m_partialInfo, std::ios::trunc);
+	info << m_version << "\n" << validator << "\n";
+}
+
+void FileDownload::removePartial() const
+{
+	std::error_code error;
+	std::filesystem::remove(m_partial, error);
+	std::filesystem::remove(m_partialInfo, error);
+}
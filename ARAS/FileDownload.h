@@ -0,0 +1,55 @@
+#pragma once
+#include <string>
+#include <filesystem>
+#include <atomic>
+#include <thread>
+
+// One file fetched over HTTPS on its own thread. The data goes to
+// "<target>.part", which a later attempt resumes with a Range request, and
+// is hashed as it arrives. The target only appears once the SHA-256 matches.
+// "<target>.part.info" records the release and the validator (ETag or
+// Last-Modified) of the partial data: it is only resumed for the same
+// release, with If-Range so a changed file is sent whole, and never without a
+// digest to check the joined file against.
+// Progress is published through atomics for the GUI thread to poll.
+class FileDownload {
+public:
+	static constexpr int maxAttempts = 3;
+
+	// version identifies the release the file belongs to, expectedSha256 is the
+	// lowercase hex digest, empty to skip the check
+	FileDownload(std::string url, std::filesystem::path target, std::string version, std::string expectedSha256);
+	~FileDownload(); // waits for the transfer
+
+	FileDownload(const FileDownload&) = delete;
+	FileDownload& operator=(const FileDownload&) = delete;
+
+	void start();
+	bool isDone() const { return m_done.load(std::memory_order_acquire); }
+	bool succeeded() const { return m_success.load(std::memory_order_acquire); }
+	uint64_t getReceived() const { return m_received.load(std::memory_order_relaxed); }
+	uint64_t getTotal() const { return m_total.load(std::memory_order_relaxed); }
+	const std::filesystem::path& getTarget() const { return m_target; }
+
+private:
+	void run();
+	bool attempt();
+	// Validator to send in If-Range, empty when the partial data must be discarded
+	std::string loadPartialValidator() const;
+	void savePartialInfo(const std::string& validator) const;
+	void removePartial() const;
+
+private:
+	const std::string m_url;
+	const std::filesystem::path m_target;
+	const std::filesystem::path m_partial;
+	const std::filesystem::path m_partialInfo;
+	const std::string m_version;
+	const std::string m_expectedSha256;
+
+	std::atomic<uint64_t> m_received{ 0 };
+	std::atomic<uint64_t> m_total{ 0 };
+	std::atomic<bool> m_done{ false };
+	std::atomic<bool> m_success{ false };
+	std::thread m_thread;
+};
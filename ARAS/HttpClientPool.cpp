@@ -0,0 +1,161 @@
+#include "HttpClientPool.h"
+
+#include "Tracer.h"
+#include "Metrics.h"
+
+// Start of the handshake running on this thread, for its trace span
+static thread_local Tracer::Clock::time_point t_handshakeStart;
+
+HttpClientPool::HttpClientPool(const std::string& host, size_t size)
+	: m_host(host)
+{
+	if (size == 0) size = 1;
+	m_clients.resize(size);
+	for (auto& slot : m_clients) {
+		slot.client = std::make_unique<httplib::Client>(m_host);
+		slot.client->set_keep_alive(true);
+		setupTls(*slot.client);
+	}
+}
+
+HttpClientPool::~HttpClientPool()
+{
+	// Clients own their SSL_CTX, they have to go before the cached session
+	m_clients.clear();
+	if (m_session) {
+		SSL_SESSION_free(m_session);
+		m_session = nullptr;
+	}
+}
+
+httplib::Result HttpClientPool::get(const std::string& path, const httplib::Headers& headers)
+{
+	size_t index;
+	{
+		TRACE_SCOPE("wait connection");
+		index = acquire();
+	}
+	httplib::Client& client = *m_clients[index].client;
+
+	bool wasOpen = client.is_socket_open() != 0;
+	httplib::Result res;
+	{
+		TRACE_SCOPE(wasOpen ? "HTTP GET" : "HTTP GET (new connection)", path);
+		res = client.Get(path, headers);
+	}
+
+	++m_requests;
+	if (wasOpen) ++m_reused;
+	else ++m_opened;
+	Metrics& metrics = Metrics::instance();
+	metrics.httpRequests.add();
+	if (!res) metrics.httpTransportErrors.add();
+	else if (res->status >= 400) metrics.httpStatusErrors.add();
+
+	release(index);
+	return res;
+}
+
+HttpClientPool::Stats HttpClientPool::getStats() const
+{
+	Stats stats;
+	stats.requests = m_requests.load();
+	stats.reused = m_reused.load();
+	stats.opened = m_opened.load();
+	stats.resumed = m_resumed.load();
+	return stats;
+}
+
+void HttpClientPool::resetStats()
+{
+	m_requests = 0;
+	m_reused = 0;
+	m_opened = 0;
+	m_resumed = 0;
+}
+
+size_t HttpClientPool::acquire()
+{
+	std::unique_lock<std::mutex> lock(m_slotMutex);
+	while (true) {
+		// Prefer a connection that is still open to avoid a new handshake
+		size_t freeIndex = m_clients.size();
+		for (size_t i = 0; i < m_clients.size(); ++i) {
+			if (m_clients[i].busy) continue;
+			if (m_clients[i].client->is_socket_open()) {
+				freeIndex = i;
+				break;
+			}
+			if (freeIndex == m_clients.size()) freeIndex = i;
+		}
+		if (freeIndex != m_clients.size()) {
+			m_clients[freeIndex].busy = true;
+			return freeIndex;
+		}
+		m_slotFree.wait(lock);
+	}
+}
+
+void HttpClientPool::release(size_t index)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_slotMutex);
+		m_clients[index].busy = false;
+	}
+	m_slotFree.notify_one();
+}
+
+void HttpClientPool::setupTls(httplib::Client& client)
+{
+	SSL_CTX* ctx = client.ssl_context();
+	if (ctx == nullptr) {
+		return; // plain http, nothing to resume
+	}
+
+	SSL_CTX_set_app_data(ctx, this);
+	SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+	SSL_CTX_sess_set_new_cb(ctx, &HttpClientPool::onNewSession);
+	SSL_CTX_set_info_callback(ctx, &HttpClientPool::onHandshakeInfo);
+
+	client.set_server_certificate_verifier([this](SSL* ssl) {
+		if (SSL_session_reused(ssl)) {
+			++m_resumed;
+		}
+		return httplib::SSLVerifierResponse::NoDecisionMade; // keep the built-in verification
+	});
+}
+
+int HttpClientPool::onNewSession(SSL* ssl, SSL_SESSION* session)
+{
+	HttpClientPool* pool = static_cast<HttpClientPool*>(SSL_CTX_get_app_data(SSL_get_SSL_CTX(ssl)));
+	if (pool == nullptr) {
+		return 0;
+	}
+	std::lock_guard<std::mutex> lock(pool->m_sessionMutex);
+	if (pool->m_session) {
+		SSL_SESSION_free(pool->m_session);
+	}
+	pool->m_session = session;
+	return 1; // we keep the reference
+}
+
+void HttpClientPool::onHandshakeInfo(const SSL* ssl, int where, int)
+{
+	if ((where & SSL_CB_HANDSHAKE_DONE) && Tracer::instance().isRecording()) {
+		Tracer::instance().record("TLS handshake", SSL_session_reused(const_cast<SSL*>(ssl)) ? "resumed" : "full", t_handshakeStart, Tracer::Clock::now());
+	}
+	// httplib gives no hook between SSL_new and SSL_connect, the handshake start
+	// notification is the last point where a session can still be offered.
+	if (!(where & SSL_CB_HANDSHAKE_START) || !SSL_in_before(ssl)) {
+		return;
+	}
+	t_handshakeStart = Tracer::Clock::now();
+	HttpClientPool* pool = static_cast<HttpClientPool*>(SSL_CTX_get_app_data(SSL_get_SSL_CTX(ssl)));
+	if (pool == nullptr) {
+		return;
+	}
+	std::lock_guard<std::mutex> lock(pool->m_sessionMutex);
+	if (pool->m_session && SSL_SESSION_is_resumable(pool->m_session)) {
+		SSL_set_session(const_cast<SSL*>(ssl), pool->m_session);
+	}
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+#define CPPHTTPLIB_OPENSSL_SUPPORT
+#include <httplib.h>
+
+// Fixed set of persistent keep-alive connections to a single host.
+// TLS sessions are shared between the connections so that a reconnect resumes
+// the previous session instead of doing a full handshake.
+class HttpClientPool {
+public:
+	struct Stats {
+		size_t requests = 0;
+		size_t reused = 0;   // request sent on an already open connection
+		size_t opened = 0;   // request had to open a new connection
+		size_t resumed = 0;  // new connection resumed a cached TLS session
+	};
+
+	HttpClientPool(const std::string& host, size_t size);
+	~HttpClientPool();
+
+	HttpClientPool(const HttpClientPool&) = delete;
+	HttpClientPool& operator=(const HttpClientPool&) = delete;
+
+	httplib::Result get(const std::string& path, const httplib::Headers& headers);
+
+	size_t size() const { return m_clients.size(); }
+	Stats getStats() const;
+	void resetStats();
+
+private:
+	struct Slot {
+		std::unique_ptr<httplib::Client> client;
+		bool busy = false;
+	};
+
+	size_t acquire();
+	void release(size_t index);
+
+	void setupTls(httplib::Client& client);
+	static int onNewSession(SSL* ssl, SSL_SESSION* session);
+	static void onHandshakeInfo(const SSL* ssl, int where, int ret);
+
+private:
+	std::string m_host;
+	std::vector<Slot> m_clients;
+	std::mutex m_slotMutex;
+	std::condition_variable m_slotFree;
+
+	std::mutex m_sessionMutex;
+	SSL_SESSION* m_session = nullptr;
+
+	std::atomic<size_t> m_requests{ 0 };
+	std::atomic<size_t> m_reused{ 0 };
+	std::atomic<size_t> m_opened{ 0 };
+	std::atomic<size_t> m_resumed{ 0 };
+};
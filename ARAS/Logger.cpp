@@ -0,0 +1,346 @@
+#include "Logger.h"
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <exception>
+#include <system_error>
+#include <mutex>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <WinSock2.h>
+#include <windows.h>
+#endif
+
+#include "DiagnosticsUtil.h"
+
+namespace {
+
+thread_local ThreadBufferHolder t_ring;
+thread_local std::string t_lineBuffer;
+thread_local bool t_lineBufferInUse = false;
+
+std::terminate_handler previousTerminate = nullptr;
+
+void onCrashSignal(int signal)
+{
+	Logger::instance().crashFlush();
+	std::signal(signal, SIG_DFL);
+	std::raise(signal);
+}
+
+void onTerminate()
+{
+	Logger::instance().crashFlush();
+	if (previousTerminate) previousTerminate();
+	std::abort();
+}
+
+#ifdef _WIN32
+LONG WINAPI onUnhandledException(EXCEPTION_POINTERS*)
+{
+	Logger::instance().crashFlush();
+	return EXCEPTION_CONTINUE_SEARCH;
+}
+#endif
+
+} // namespace
+
+Logger& Logger::instance()
+{
+	static Logger logger;
+	return logger;
+}
+
+Logger::~Logger()
+{
+	stop();
+}
+
+const char* Logger::levelName(LogLevel level)
+{
+	switch (level) {
+	case LogLevel::Debug: return "DEBUG";
+	case LogLevel::Info: return "INFO";
+	case LogLevel::Warning: return "WARN";
+	case LogLevel::Error: return "ERROR";
+	}
+	return "";
+}
+
+bool Logger::start(const Options& options)
+{
+	stop();
+	{
+		OutputLock lock(*this);
+		m_options = options;
+		m_level = options.level;
+		if (!m_options.file.empty()) {
+			rotate(); // every session starts a new file, the previous one becomes file.1
+			if (!openFile()) {
+				std::cerr << "Failed to open log file " << m_options.file.string() << std::endl;
+				m_options.console = true;
+			}
+		}
+	}
+
+	// Once per process, a second start would chain onTerminate to itself
+	static std::once_flag crashHandlersInstalled;
+	std::call_once(crashHandlersInstalled, []() {
+		previousTerminate = std::set_terminate(onTerminate);
+		for (int signal : { SIGSEGV, SIGABRT, SIGFPE, SIGILL }) {
+			std::signal(signal, onCrashSignal);
+		}
+#ifdef _WIN32
+		SetUnhandledExceptionFilter(onUnhandledException);
+#endif
+	});
+
+	m_running = true;
+	m_writer = std::thread(&Logger::writerLoop, this);
+	return m_file != nullptr || m_options.file.empty();
+}
+
+void Logger::stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_wakeMutex);
+		if (!m_running.exchange(false)) {
+			return;
+		}
+	}
+	m_wake.notify_all();
+	if (m_writer.joinable()) {
+		m_writer.join();
+	}
+
+	OutputLock lock(*this);
+	drainAndWrite();
+	if (m_file) {
+		std::fclose(m_file);
+		m_file = nullptr;
+	}
+}
+
+void Logger::flush()
+{
+	OutputLock lock(*this);
+	drainAndWrite();
+}
+
+void Logger::crashFlush()
+{
+	// Crashed in the middle of writing: the lock is ours and the output state is not to be trusted
+	if (m_outputOwner.load() == std::this_thread::get_id()) {
+		return;
+	}
+	// The crash may have happened while the writer held the lock
+	std::unique_lock<std::mutex> lock(m_outputMutex, std::defer_lock);
+	for (int i = 0; i < 100 && !lock.try_lock(); ++i) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	if (!lock.owns_lock()) {
+		return;
+	}
+	m_outputOwner.store(std::this_thread::get_id()); // a second fault while flushing returns at once
+	drainAndWrite();
+	if (m_file) {
+		std::fflush(m_file);
+	}
+	m_outputOwner.store(std::thread::id());
+}
+
+Logger::OutputLock::OutputLock(Logger& logger)
+	: logger(logger)
+{
+	logger.m_outputMutex.lock();
+	logger.m_outputOwner.store(std::this_thread::get_id());
+}
+
+Logger::OutputLock::~OutputLock()
+{
+	logger.m_outputOwner.store(std::thread::id());
+	logger.m_outputMutex.unlock();
+}
+
+void Logger::write(LogLevel level, std::string_view text)
+{
+	if (!m_running.load(std::memory_order_acquire)) {
+		(level >= LogLevel::Warning ? std::cerr : std::cout) << text << std::endl;
+		return;
+	}
+
+	Ring* ring = threadRing();
+	size_t head = ring->head.load(std::memory_order_relaxed);
+	size_t used = head - ring->tail.load(std::memory_order_acquire);
+	if (used >= ringCapacity) {
+		m_dropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+	Record& record = ring->records[head % ringCapacity];
+	record.time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+	record.level = level;
+	record.thread = ring->thread;
+	record.text.assign(text); // reuses the slot's capacity once warmed up
+	ring->head.store(head + 1, std::memory_order_release);
+
+	// Errors are written right away, a burst gets the writer going before the ring fills up
+	if (level == LogLevel::Error || used + 1 == ringCapacity / 2) {
+		m_wake.notify_one();
+	}
+}
+
+Logger::Ring* Logger::threadRing()
+{
+	if (t_ring.buffer) {
+		return static_cast<Ring*>(t_ring.buffer.get());
+	}
+	auto ring = std::make_shared<Ring>();
+	ring->thread = m_nextThread.fetch_add(1, std::memory_order_relaxed);
+	{
+		std::lock_guard<std::mutex> lock(m_ringsMutex);
+		m_rings.push_back(ring);
+	}
+	t_ring.closed = &ring->closed;
+	t_ring.buffer = ring;
+	return ring.get();
+}
+
+void Logger::writerLoop()
+{
+	std::unique_lock<std::mutex> wakeLock(m_wakeMutex);
+	while (m_running) {
+		m_wake.wait_for(wakeLock, writeInterval);
+		wakeLock.unlock();
+		{
+			OutputLock lock(*this);
+			drainAndWrite();
+		}
+		wakeLock.lock();
+	}
+}
+
+void Logger::drainAndWrite()
+{
+	// Records are swapped with the ring slots, both sides keep their string capacity
+	size_t count = 0;
+	auto nextRecord = [this, &count]() -> Record& {
+		if (count == m_batch.size()) {
+			m_batch.emplace_back();
+		}
+		return m_batch[count++];
+	};
+	{
+		std::lock_guard<std::mutex> lock(m_ringsMutex);
+		for (auto it = m_rings.begin(); it != m_rings.end();) {
+			Ring& ring = **it;
+			bool closed = ring.closed.load(std::memory_order_acquire);
+			size_t tail = ring.tail.load(std::memory_order_relaxed);
+			size_t head = ring.head.load(std::memory_order_acquire);
+			for (; tail != head; ++tail) {
+				Record& record = ring.records[tail % ringCapacity];
+				Record& copy = nextRecord();
+				copy.time = record.time;
+				copy.level = record.level;
+				copy.thread = record.thread;
+				copy.text.swap(record.text);
+			}
+			ring.tail.store(tail, std::memory_order_release);
+			it = closed ? m_rings.erase(it) : it + 1;
+		}
+	}
+
+	uint64_t dropped = m_dropped.load(std::memory_order_relaxed);
+	if (dropped != m_reportedDropped) {
+		Record& record = nextRecord();
+		record.time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+		record.level = LogLevel::Warning;
+		record.thread = 0;
+		record.text = std::to_string(dropped - m_reportedDropped) + " log lines dropped, a thread logged faster than the writer";
+		m_reportedDropped = dropped;
+	}
+	if (count == 0) {
+		return;
+	}
+	std::stable_sort(m_batch.begin(), m_batch.begin() + count, [](const Record& a, const Record& b) { return a.time < b.time; });
+	writeBatch(std::span<const Record>(m_batch.data(), count));
+}
+
+void Logger::writeBatch(std::span<const Record> batch)
+{
+	m_text.clear();
+	for (const Record& record : batch) {
+		appendUtcTime(record.time, "%Y-%m-%d %H:%M:%S", ".%03dZ", m_text);
+		m_text += " [";
+		m_text += levelName(record.level);
+		m_text += "] [T";
+		m_text += std::to_string(record.thread);
+		m_text += "] ";
+		m_text += record.text;
+		m_text += '\n';
+	}
+
+	if (m_file) {
+		if (m_fileSize > 0 && m_fileSize + m_text.size() > m_options.maxFileSize) {
+			std::fclose(m_file);
+			m_file = nullptr;
+			rotate();
+			openFile();
+		}
+		if (m_file) {
+			std::fwrite(m_text.data(), 1, m_text.size(), m_file);
+			std::fflush(m_file);
+			m_fileSize += m_text.size();
+		}
+	}
+	if (m_options.console) {
+		for (const Record& record : batch) {
+			(record.level >= LogLevel::Warning ? std::cerr : std::cout) << record.text << '\n';
+		}
+		std::cout.flush();
+		std::cerr.flush();
+	}
+}
+
+bool Logger::openFile()
+{
+	m_file = std::fopen(m_options.file.string().c_str(), "wb");
+	m_fileSize = 0;
+	return m_file != nullptr;
+}
+
+void Logger::rotate()
+{
+	std::error_code error;
+	if (!std::filesystem::exists(m_options.file, error)) {
+		return;
+	}
+	auto numbered = [this](int index) {
+		std::filesystem::path path = m_options.file;
+		return path.replace_extension(std::to_string(index) + m_options.file.extension().string());
+	};
+	std::filesystem::remove(numbered(m_options.maxFiles), error);
+	for (int i = m_options.maxFiles - 1; i >= 1; --i) {
+		std::filesystem::rename(numbered(i), numbered(i + 1), error);
+	}
+	std::filesystem::rename(m_options.file, numbered(1), error);
+}
+
+LogLine::LogLine(LogLevel level)
+	: m_level(level), m_text(t_lineBufferInUse ? m_own : t_lineBuffer)
+{
+	if (&m_text == &t_lineBuffer) {
+		t_lineBufferInUse = true;
+	}
+	m_text.clear();
+}
+
+LogLine::~LogLine()
+{
+	Logger::instance().write(m_level, m_text);
+	if (&m_text == &t_lineBuffer) {
+		t_lineBufferInUse = false;
+	}
+}
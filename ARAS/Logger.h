@@ -0,0 +1,164 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <filesystem>
+#include <atomic>
+#include <array>
+#include <vector>
+#include <span>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <cstdio>
+#include <charconv>
+#include <sstream>
+#include <type_traits>
+
+enum class LogLevel {
+	Debug,
+	Info,
+	Warning,
+	Error
+};
+
+// Asynchronous logger. Every thread appends to its own lock-free ring, a
+// background thread merges the rings about every 50 ms and writes them with
+// one flush per batch. A full ring drops lines rather than blocking the
+// thread logging. Before start() (or after stop()) lines are printed directly.
+class Logger {
+public:
+	struct Options {
+		std::filesystem::path file; // empty: console only
+		LogLevel level = LogLevel::Info;
+		uint64_t maxFileSize = 5 * 1024 * 1024; // then rotated to file.1, file.2...
+		int maxFiles = 3;
+		bool console = false; // also print, warnings and errors on stderr
+	};
+
+	static constexpr size_t ringCapacity = 1024; // lines per thread
+	static constexpr std::chrono::milliseconds writeInterval{ 50 };
+
+	static Logger& instance();
+
+	// Also installs the crash handlers that flush what is still queued
+	bool start(const Options& options);
+	void stop();
+	// Writes everything logged so far, from any thread
+	void flush();
+	// Best effort flush from a crash handler, gives up if the writer is stuck
+	void crashFlush();
+
+	bool isEnabled(LogLevel level) const { return level >= m_level.load(std::memory_order_relaxed); }
+	void setLevel(LogLevel level) { m_level.store(level, std::memory_order_relaxed); }
+	void write(LogLevel level, std::string_view text);
+	uint64_t getDropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+	static const char* levelName(LogLevel level);
+
+private:
+	struct Record {
+		int64_t time = 0; // ms since epoch
+		LogLevel level = LogLevel::Info;
+		uint32_t thread = 0;
+		std::string text;
+	};
+
+	// Single producer (its thread) / single consumer (whoever holds m_outputMutex)
+	struct Ring {
+		std::array<Record, ringCapacity> records;
+		std::atomic<size_t> head{ 0 };
+		std::atomic<size_t> tail{ 0 };
+		uint32_t thread = 0;
+		std::atomic<bool> closed{ false }; // thread exited
+	};
+
+	// m_outputMutex with its owner recorded, a crash on that thread must not lock it again
+	struct OutputLock {
+		explicit OutputLock(Logger& logger);
+		~OutputLock();
+
+		OutputLock(const OutputLock&) = delete;
+		OutputLock& operator=(const OutputLock&) = delete;
+
+		Logger& logger;
+	};
+
+	Logger() = default;
+	~Logger();
+
+	Ring* threadRing();
+	void writerLoop();
+	void drainAndWrite(); // m_outputMutex held
+	void writeBatch(std::span<const Record> batch);
+	bool openFile();
+	void rotate();
+
+private:
+	std::atomic<LogLevel> m_level{ LogLevel::Info };
+	std::atomic<bool> m_running{ false };
+	std::atomic<uint64_t> m_dropped{ 0 };
+	std::atomic<uint32_t> m_nextThread{ 1 };
+	Options m_options;
+
+	std::mutex m_ringsMutex;
+	std::vector<std::shared_ptr<Ring>> m_rings;
+
+	std::mutex m_outputMutex;
+	std::atomic<std::thread::id> m_outputOwner{};
+	std::FILE* m_file = nullptr;
+	uint64_t m_fileSize = 0;
+	uint64_t m_reportedDropped = 0;
+	std::vector<Record> m_batch; // reused, only the front part is the current batch
+	std::string m_text;
+
+	std::mutex m_wakeMutex;
+	std::condition_variable m_wake;
+	std::thread m_writer;
+};
+
+// One log line, formatted on the calling thread and queued when destroyed
+class LogLine {
+public:
+	explicit LogLine(LogLevel level);
+	~LogLine();
+
+	LogLine(const LogLine&) = delete;
+	LogLine& operator=(const LogLine&) = delete;
+
+	template <typename T>
+	LogLine& operator<<(const T& value)
+	{
+		if constexpr (std::is_same_v<T, bool>) {
+			m_text += value ? '1' : '0';
+		}
+		else if constexpr (std::is_same_v<T, char>) {
+			m_text += value;
+		}
+		else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+			m_text += std::string_view(value);
+		}
+		else if constexpr (std::is_arithmetic_v<T>) {
+			char buffer[32];
+			auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+			m_text.append(buffer, result.ptr);
+		}
+		else {
+			std::ostringstream stream;
+			stream << value;
+			m_text += stream.str();
+		}
+		return *this;
+	}
+
+private:
+	LogLevel m_level;
+	std::string m_own;
+	std::string& m_text; // the thread's reusable buffer unless a line is already being built
+};
+
+#define ARAS_LOG(level) if (!Logger::instance().isEnabled(level)) {} else LogLine(level)
+#define LOG_DEBUG ARAS_LOG(LogLevel::Debug)
+#define LOG_INFO ARAS_LOG(LogLevel::Info)
+#define LOG_WARNING ARAS_LOG(LogLevel::Warning)
+#define LOG_ERROR ARAS_LOG(LogLevel::Error)
@@ -0,0 +1,53 @@
+#include "LoopWaker.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <WinSock2.h>
+#include <windows.h>
+#endif
+
+#ifdef _WIN32
+LoopWaker::LoopWaker()
+	: m_event(CreateEventW(nullptr, FALSE, FALSE, nullptr))
+{
+}
+
+LoopWaker::~LoopWaker()
+{
+	if (m_event != nullptr) {
+		CloseHandle(m_event);
+	}
+}
+
+void LoopWaker::wake()
+{
+	SetEvent(m_event);
+}
+
+void LoopWaker::wait(std::chrono::milliseconds timeout)
+{
+	// MWMO_INPUTAVAILABLE also returns for messages already seen by an earlier PeekMessage
+	MsgWaitForMultipleObjectsEx(m_event != nullptr ? 1 : 0, &m_event, static_cast<DWORD>(timeout.count()), QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+}
+#else
+LoopWaker::LoopWaker() = default;
+
+LoopWaker::~LoopWaker() = default;
+
+void LoopWaker::wake()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_woken = true;
+	}
+	m_condition.notify_one();
+}
+
+void LoopWaker::wait(std::chrono::milliseconds timeout)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_condition.wait_for(lock, timeout, [this] { return m_woken; });
+	m_woken = false;
+}
+#endif
@@ -0,0 +1,30 @@
+#pragma once
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+
+// Lets the GUI thread sleep until a window receives input or a worker posts
+// something for it, instead of polling every window in a busy loop.
+class LoopWaker {
+public:
+	LoopWaker();
+	~LoopWaker();
+
+	LoopWaker(const LoopWaker&) = delete;
+	LoopWaker& operator=(const LoopWaker&) = delete;
+
+	// Any thread
+	void wake();
+	// GUI thread only. Returns on window input, wake() or after the timeout.
+	void wait(std::chrono::milliseconds timeout);
+
+private:
+#ifdef _WIN32
+	void* m_event = nullptr; // auto reset event, HANDLE
+#else
+	// Window input does not wake this one, the caller keeps the timeout short
+	std::mutex m_mutex;
+	std::condition_variable m_condition;
+	bool m_woken = false;
+#endif
+};
@@ -0,0 +1,83 @@
+#include "MetarCache.h"
+#include <mutex>
+
+#include "Metrics.h"
+
+bool MetarCache::lookup(const std::string& oaci, WindData& windData)
+{
+	{
+		std::shared_lock<std::shared_mutex> lock(m_mutex);
+		auto it = m_entries.find(oaci);
+		if (it != m_entries.end() && Clock::now() < it->second.expires) {
+			windData = it->second.windData;
+			++m_hits;
+			Metrics::instance().cacheHits.add();
+			return true;
+		}
+	}
+	++m_misses;
+	Metrics::instance().cacheMisses.add();
+	return false;
+}
+
+bool MetarCache::lookupStale(const std::string& oaci, Entry& entry) const
+{
+	std::shared_lock<std::shared_mutex> lock(m_mutex);
+	auto it = m_entries.find(oaci);
+	if (it == m_entries.end()) {
+		return false;
+	}
+	entry = it->second;
+	return true;
+}
+
+void MetarCache::store(const std::string& oaci, const WindData& windData, Clock::time_point observed, Clock::time_point fetched)
+{
+	Entry entry;
+	entry.windData = windData;
+	entry.windData.stale = false;
+	entry.observed = observed;
+	entry.fetched = fetched;
+
+	// Expiry is relative to the fetch, a report restored from disk must not
+	// look fresh just because its cycle is computed from the current time
+	if (observed == Clock::time_point{} || observed > fetched + issuanceInterval) {
+		entry.expires = fetched + fallbackTtl;
+	}
+	else {
+		entry.expires = nextExpectedIssuance(observed, fetched);
+	}
+
+	std::unique_lock<std::shared_mutex> lock(m_mutex);
+	m_entries[oaci] = entry;
+	++m_version;
+}
+
+void MetarCache::clear()
+{
+	std::unique_lock<std::shared_mutex> lock(m_mutex);
+	m_entries.clear();
+}
+
+std::vector<std::pair<std::string, MetarCache::Entry>> MetarCache::getEntries() const
+{
+	std::shared_lock<std::shared_mutex> lock(m_mutex);
+	return std::vector<std::pair<std::string, Entry>>(m_entries.begin(), m_entries.end());
+}
+
+void MetarCache::resetStats()
+{
+	m_hits = 0;
+	m_misses = 0;
+}
+
+MetarCache::Clock::time_point MetarCache::nextExpectedIssuance(Clock::time_point observed, Clock::time_point now)
+{
+	// Hourly stations or late reports: skip the cycles that are already over,
+	// the entry is then re-checked once per half hour until a newer report shows up
+	Clock::time_point next = observed + issuanceInterval;
+	while (next + publicationDelay <= now) {
+		next += issuanceInterval;
+	}
+	return next + publicationDelay;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <string>
+#include <unordered_map>
+#include <shared_mutex>
+#include <chrono>
+#include <atomic>
+#include <vector>
+#include <cstdint>
+#include <utility>
+
+#include "WindData.h"
+
+// Last known wind per ICAO. An entry stays fresh until the next METAR of the
+// station is expected to be published, so repeated lookups inside the same
+// issuance cycle never hit the network.
+class MetarCache {
+public:
+	using Clock = std::chrono::system_clock;
+
+	// METARs are issued every half hour and show up on AVWX a few minutes later
+	static constexpr std::chrono::minutes issuanceInterval{ 30 };
+	static constexpr std::chrono::minutes publicationDelay{ 5 };
+	// Used when the report carries no usable observation time
+	static constexpr std::chrono::minutes fallbackTtl{ 5 };
+
+	struct Entry {
+		WindData windData{};
+		Clock::time_point observed{};
+		Clock::time_point fetched{};
+		Clock::time_point expires{};
+	};
+
+	bool lookup(const std::string& oaci, WindData& windData);
+	// Last known entry of the station even if it expired, for offline fallback
+	bool lookupStale(const std::string& oaci, Entry& entry) const;
+	void store(const std::string& oaci, const WindData& windData, Clock::time_point observed, Clock::time_point fetched = Clock::now());
+	void clear();
+
+	std::vector<std::pair<std::string, Entry>> getEntries() const;
+	// Bumped by every store, the snapshot is dirty until the version it saved is current
+	uint64_t getVersion() const { return m_version.load(); }
+	bool isDirty() const { return m_version.load() != m_savedVersion.load(); }
+	void markSaved(uint64_t version) { m_savedVersion = version; }
+
+	size_t getHits() const { return m_hits.load(); }
+	size_t getMisses() const { return m_misses.load(); }
+	void resetStats();
+
+	static Clock::time_point nextExpectedIssuance(Clock::time_point observed, Clock::time_point now);
+
+private:
+	mutable std::shared_mutex m_mutex;
+	std::unordered_map<std::string, Entry> m_entries;
+
+	std::atomic<uint64_t> m_version{ 0 };
+	std::atomic<uint64_t> m_savedVersion{ 0 };
+	std::atomic<size_t> m_hits{ 0 };
+	std::atomic<size_t> m_misses{ 0 };
+};
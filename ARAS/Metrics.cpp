@@ -0,0 +1,132 @@
+#include "Metrics.h"
+#include <cstdio>
+#include <algorithm>
+#include <mutex>
+
+namespace {
+
+void appendNumber(double value, std::string& out)
+{
+	char buffer[32];
+	std::snprintf(buffer, sizeof(buffer), "%.9g", value);
+	out += buffer;
+}
+
+void appendHeader(const char* name, const char* type, const char* help, std::string& out)
+{
+	out.append("# HELP ").append(name).append(" ").append(help).append("\n");
+	out.append("# TYPE ").append(name).append(" ").append(type).append("\n");
+}
+
+void appendCounter(const char* name, const char* labels, const Counter& counter, std::string& out)
+{
+	out.append(name);
+	if (labels[0] != '\0') {
+		out.append("{").append(labels).append("}");
+	}
+	out.append(" ").append(std::to_string(counter.get())).append("\n");
+}
+
+} // namespace
+
+Histogram::Histogram(std::initializer_list<double> bounds)
+	: m_bounds(bounds)
+	, m_buckets(std::make_unique<std::atomic<uint64_t>[]>(bounds.size() + 1))
+{
+}
+
+void Histogram::observe(double seconds)
+{
+	size_t bucket = 0;
+	while (bucket < m_bounds.size() && seconds > m_bounds[bucket]) {
+		++bucket;
+	}
+	m_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+	m_sumNanoseconds.fetch_add(static_cast<uint64_t>(std::max(seconds, 0.0) * 1e9), std::memory_order_relaxed);
+}
+
+void Histogram::format(const std::string& name, const std::string& labels, std::string& out) const
+{
+	std::string prefix = labels.empty() ? "" : labels + ",";
+	uint64_t cumulative = 0;
+	for (size_t i = 0; i <= m_bounds.size(); ++i) {
+		cumulative += m_buckets[i].load(std::memory_order_relaxed);
+		out.append(name).append("_bucket{").append(prefix).append("le=\"");
+		if (i < m_bounds.size()) {
+			appendNumber(m_bounds[i], out);
+		}
+		else {
+			out.append("+Inf");
+		}
+		out.append("\"} ").append(std::to_string(cumulative)).append("\n");
+	}
+	std::string suffix = labels.empty() ? "" : "{" + labels + "}";
+	out.append(name).append("_sum").append(suffix).append(" ");
+	appendNumber(static_cast<double>(m_sumNanoseconds.load(std::memory_order_relaxed)) / 1e9, out);
+	out.append("\n");
+	out.append(name).append("_count").append(suffix).append(" ").append(std::to_string(cumulative)).append("\n");
+}
+
+Metrics& Metrics::instance()
+{
+	static Metrics metrics;
+	return metrics;
+}
+
+void Metrics::observeMetarFetch(const std::string& airport, double seconds)
+{
+	{
+		std::shared_lock<std::shared_mutex> lock(m_metarFetchMutex);
+		auto it = m_metarFetchSeconds.find(airport);
+		if (it != m_metarFetchSeconds.end()) {
+			it->second->observe(seconds);
+			return;
+		}
+	}
+	std::unique_lock<std::shared_mutex> lock(m_metarFetchMutex);
+	auto& histogram = m_metarFetchSeconds[airport];
+	if (!histogram) {
+		histogram = std::make_unique<Histogram>(std::initializer_list<double>{ 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10 });
+	}
+	histogram->observe(seconds);
+}
+
+std::string Metrics::format() const
+{
+	std::string out;
+	out.reserve(4096);
+
+	appendHeader("aras_metar_fetch_seconds", "histogram", "Time until an airport's METAR was received, batched airports share their request's time.", out);
+	{
+		std::shared_lock<std::shared_mutex> lock(m_metarFetchMutex);
+		for (const auto& [airport, histogram] : m_metarFetchSeconds) {
+			histogram->format("aras_metar_fetch_seconds", "airport=\"" + airport + "\"", out);
+		}
+	}
+
+	appendHeader("aras_http_requests_total", "counter", "METAR requests sent.", out);
+	appendCounter("aras_http_requests_total", "", httpRequests, out);
+	appendHeader("aras_http_errors_total", "counter", "METAR requests that failed, by kind.", out);
+	appendCounter("aras_http_errors_total", "kind=\"transport\"", httpTransportErrors, out);
+	appendCounter("aras_http_errors_total", "kind=\"status\"", httpStatusErrors, out);
+
+	appendHeader("aras_metar_cache_hits_total", "counter", "Winds served from the METAR cache.", out);
+	appendCounter("aras_metar_cache_hits_total", "", cacheHits, out);
+	appendHeader("aras_metar_cache_misses_total", "counter", "Winds that had to be fetched.", out);
+	appendCounter("aras_metar_cache_misses_total", "", cacheMisses, out);
+	appendHeader("aras_metar_stale_total", "counter", "Failed fetches answered with the last known wind.", out);
+	appendCounter("aras_metar_stale_total", "", staleWinds, out);
+
+	appendHeader("aras_assignment_seconds", "histogram", "Duration of runway assignments.", out);
+	assignSeconds.format("aras_assignment_seconds", "mode=\"assign\"", out);
+	refreshSeconds.format("aras_assignment_seconds", "mode=\"refresh\"", out);
+
+	appendHeader("aras_rwy_writes_total", "counter", ".rwy file updates, by result.", out);
+	appendCounter("aras_rwy_writes_total", "result=\"written\"", rwyWritten, out);
+	appendCounter("aras_rwy_writes_total", "result=\"skipped\"", rwySkipped, out);
+	appendCounter("aras_rwy_writes_total", "result=\"failed\"", rwyFailed, out);
+
+	appendHeader("aras_gui_frame_seconds", "histogram", "Time to process and draw a GUI frame.", out);
+	frameSeconds.format("aras_gui_frame_seconds", "", out);
+	return out;
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <map>
+#include <shared_mutex>
+#include <initializer_list>
+
+// Monotonic counter, only ever incremented
+class Counter {
+public:
+	void add(uint64_t value = 1) { m_value.fetch_add(value, std::memory_order_relaxed); }
+	uint64_t get() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+	std::atomic<uint64_t> m_value{ 0 };
+};
+
+// Fixed bucket histogram of durations in seconds, observe() is a few relaxed atomic adds
+class Histogram {
+public:
+	Histogram(std::initializer_list<double> bounds);
+
+	void observe(double seconds);
+	// Appends the _bucket, _sum and _count lines, labels go inside the braces ("airport=\"LFMN\"")
+	void format(const std::string& name, const std::string& labels, std::string& out) const;
+
+private:
+	std::vector<double> m_bounds; // upper bounds, +Inf is implicit
+	std::unique_ptr<std::atomic<uint64_t>[]> m_buckets; // not cumulative, one more than m_bounds
+	std::atomic<uint64_t> m_sumNanoseconds{ 0 };
+};
+
+// Process wide counters, served in the Prometheus text format by MetricsServer.
+// Updated whether or not the endpoint is enabled.
+class Metrics {
+public:
+	static Metrics& instance();
+
+	void observeMetarFetch(const std::string& airport, double seconds);
+	std::string format() const;
+
+	Counter httpRequests;
+	Counter httpTransportErrors; // no response at all
+	Counter httpStatusErrors; // response with a status >= 400
+	Counter cacheHits;
+	Counter cacheMisses;
+	Counter staleWinds; // fetch failed, last known wind used
+	Counter rwyWritten;
+	Counter rwySkipped; // content unchanged, file left as is
+	Counter rwyFailed;
+	Histogram assignSeconds{ 0.1, 0.25, 0.5, 1, 2.5, 5, 10, 30 };
+	Histogram refreshSeconds{ 0.1, 0.25, 0.5, 1, 2.5, 5, 10, 30 };
+	Histogram frameSeconds{ 0.001, 0.002, 0.005, 0.008, 0.016, 0.033, 0.05, 0.1, 0.25 };
+
+private:
+	Metrics() = default;
+
+	mutable std::shared_mutex m_metarFetchMutex; // only locked exclusively for a new airport
+	std::map<std::string, std::unique_ptr<Histogram>> m_metarFetchSeconds;
+};
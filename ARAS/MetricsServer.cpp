@@ -0,0 +1,43 @@
+#include "MetricsServer.h"
+
+#include "Metrics.h"
+#include "Logger.h"
+
+MetricsServer::~MetricsServer()
+{
+	stop();
+}
+
+bool MetricsServer::start(int port)
+{
+	stop();
+	m_server = std::make_unique<httplib::Server>();
+	// Scrapes are rare and tiny, one thread is plenty
+	m_server->new_task_queue = []() { return new httplib::ThreadPool(1); };
+	m_server->Get("/metrics", [](const httplib::Request&, httplib::Response& res) {
+		res.set_content(Metrics::instance().format(), "text/plain; version=0.0.4; charset=utf-8");
+	});
+
+	if (!m_server->bind_to_port("127.0.0.1", port)) {
+		LOG_ERROR << "Metrics endpoint could not listen on port " << port << ".";
+		m_server.reset();
+		return false;
+	}
+	m_thread = std::thread([this]() {
+		m_server->listen_after_bind();
+	});
+	m_server->wait_until_ready(); // stop() is a no-op on a server not listening yet
+	LOG_INFO << "Metrics available on http://127.0.0.1:" << port << "/metrics";
+	return true;
+}
+
+void MetricsServer::stop()
+{
+	if (m_server) {
+		m_server->stop();
+	}
+	if (m_thread.joinable()) {
+		m_thread.join();
+	}
+	m_server.reset();
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <string>
+#include <thread>
+#include <memory>
+
+#define CPPHTTPLIB_OPENSSL_SUPPORT
+#include <httplib.h>
+
+// Serves Metrics on http://127.0.0.1:<port>/metrics for Prometheus to scrape.
+// Only reachable from this machine.
+class MetricsServer {
+public:
+	MetricsServer() = default;
+	~MetricsServer();
+
+	MetricsServer(const MetricsServer&) = delete;
+	MetricsServer& operator=(const MetricsServer&) = delete;
+
+	bool start(int port);
+	void stop();
+	bool isRunning() const { return m_thread.joinable(); }
+
+private:
+	std::unique_ptr<httplib::Server> m_server;
+	std::thread m_thread;
+};
@@ -0,0 +1,69 @@
+#include "RefreshScheduler.h"
+#include <algorithm>
+
+RefreshScheduler::~RefreshScheduler()
+{
+	stop();
+}
+
+void RefreshScheduler::start(std::chrono::minutes interval, std::chrono::minutes offset, std::function<void()> task)
+{
+	stop();
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_interval = std::clamp(interval, std::chrono::minutes{ 1 }, std::chrono::minutes{ 24 * 60 });
+	m_offset = std::chrono::minutes{ ((offset.count() % m_interval.count()) + m_interval.count()) % m_interval.count() };
+	m_task = std::move(task);
+	m_nextRun = nextAlignedTime(Clock::now(), m_interval, m_offset);
+	m_stop = false;
+	m_thread = std::thread(&RefreshScheduler::loop, this);
+}
+
+void RefreshScheduler::stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_wake.notify_all();
+	if (m_thread.joinable()) {
+		m_thread.join();
+	}
+}
+
+bool RefreshScheduler::isRunning() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_thread.joinable() && !m_stop;
+}
+
+RefreshScheduler::Clock::time_point RefreshScheduler::getNextRun() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_nextRun;
+}
+
+RefreshScheduler::Clock::time_point RefreshScheduler::nextAlignedTime(Clock::time_point now, std::chrono::minutes interval, std::chrono::minutes offset)
+{
+	auto minutes = std::chrono::floor<std::chrono::minutes>(now) - offset;
+	auto cycles = minutes.time_since_epoch() / interval;
+	Clock::time_point next = Clock::time_point{ (cycles + 1) * interval } + offset;
+	while (next <= now) {
+		next += interval;
+	}
+	return next;
+}
+
+void RefreshScheduler::loop()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (!m_stop) {
+		if (m_wake.wait_until(lock, m_nextRun, [this] { return m_stop; })) {
+			return;
+		}
+		m_nextRun = nextAlignedTime(Clock::now(), m_interval, m_offset);
+
+		lock.unlock();
+		m_task();
+		lock.lock();
+	}
+}
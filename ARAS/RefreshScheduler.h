@@ -0,0 +1,41 @@
+#pragma once
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// Runs a task on its own thread at fixed minutes of the hour (UTC). With a 30
+// minute interval and a 5 minute offset it wakes at :05 and :35, right after
+// the half hourly METARs are published.
+class RefreshScheduler {
+public:
+	using Clock = std::chrono::system_clock;
+
+	RefreshScheduler() = default;
+	~RefreshScheduler();
+
+	RefreshScheduler(const RefreshScheduler&) = delete;
+	RefreshScheduler& operator=(const RefreshScheduler&) = delete;
+
+	// Restarts the schedule if already running. The first run is at the next aligned time.
+	void start(std::chrono::minutes interval, std::chrono::minutes offset, std::function<void()> task);
+	void stop();
+	bool isRunning() const;
+	Clock::time_point getNextRun() const;
+
+	static Clock::time_point nextAlignedTime(Clock::time_point now, std::chrono::minutes interval, std::chrono::minutes offset);
+
+private:
+	void loop();
+
+private:
+	mutable std::mutex m_mutex;
+	std::condition_variable m_wake;
+	std::thread m_thread;
+	bool m_stop = false;
+	std::chrono::minutes m_interval{ 30 };
+	std::chrono::minutes m_offset{ 0 };
+	Clock::time_point m_nextRun{};
+	std::function<void()> m_task;
+};
@@ -0,0 +1,193 @@
+#include "ResourceCache.h"
+#include <string>
+#include <unordered_map>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <WinSock2.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "Logger.h"
+
+namespace {
+
+// Read-only view of a whole file, the pages are only read when decoded
+class MappedFile {
+public:
+	explicit MappedFile(const std::filesystem::path& path)
+	{
+#ifdef _WIN32
+		m_file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (m_file == INVALID_HANDLE_VALUE) return;
+		LARGE_INTEGER size{};
+		if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0) return;
+		m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (m_mapping == nullptr) return;
+		m_data = MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+		if (m_data != nullptr) m_size = static_cast<size_t>(size.QuadPart);
+#else
+		m_file = open(path.c_str(), O_RDONLY);
+		if (m_file < 0) return;
+		struct stat status {};
+		if (fstat(m_file, &status) != 0 || status.st_size == 0) return;
+		void* data = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, m_file, 0);
+		if (data == MAP_FAILED) return;
+		m_data = data;
+		m_size = static_cast<size_t>(status.st_size);
+#endif
+	}
+
+	~MappedFile()
+	{
+#ifdef _WIN32
+		if (m_data != nullptr) UnmapViewOfFile(m_data);
+		if (m_mapping != nullptr) CloseHandle(m_mapping);
+		if (m_file != INVALID_HANDLE_VALUE) CloseHandle(m_file);
+#else
+		if (m_data != nullptr) munmap(m_data, m_size);
+		if (m_file >= 0) close(m_file);
+#endif
+	}
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	const void* data() const { return m_data; }
+	size_t size() const { return m_size; }
+	bool isOpen() const { return m_data != nullptr; }
+
+private:
+#ifdef _WIN32
+	HANDLE m_file = INVALID_HANDLE_VALUE;
+	HANDLE m_mapping = nullptr;
+#else
+	int m_file = -1;
+#endif
+	void* m_data = nullptr;
+	size_t m_size = 0;
+};
+
+// sf::Font reads the file data while glyphs are rendered, the mapping lives as long as the font
+struct MappedFont {
+	explicit MappedFont(const std::filesystem::path& path) : file(path) {}
+
+	MappedFile file;
+	sf::Font font;
+};
+
+template <typename T>
+using Entries = std::unordered_map<std::string, std::weak_ptr<T>>;
+
+Entries<const sf::Font> fonts;
+Entries<tgui::BackendFont> guiFonts;
+Entries<const sf::Image> images;
+Entries<const sf::Texture> textures;
+
+template <typename T>
+std::shared_ptr<T> findEntry(Entries<T>& entries, const std::string& key)
+{
+	auto entry = entries.find(key);
+	if (entry == entries.end()) {
+		return nullptr;
+	}
+	std::shared_ptr<T> resource = entry->second.lock();
+	if (!resource) {
+		entries.erase(entry);
+	}
+	return resource;
+}
+
+} // namespace
+
+namespace ResourceCache {
+
+std::shared_ptr<const sf::Font> getFont(const std::filesystem::path& path)
+{
+	std::string key = path.string();
+	if (std::shared_ptr<const sf::Font> font = findEntry(fonts, key)) {
+		return font;
+	}
+
+	auto mappedFont = std::make_shared<MappedFont>(path);
+	bool loaded = mappedFont->file.isOpen()
+		? mappedFont->font.openFromMemory(mappedFont->file.data(), mappedFont->file.size())
+		: mappedFont->font.openFromFile(path);
+	if (!loaded) {
+		LOG_ERROR << "Failed to load font: " << key;
+		return nullptr;
+	}
+	std::shared_ptr<const sf::Font> font(mappedFont, &mappedFont->font);
+	fonts[key] = font;
+	return font;
+}
+
+tgui::Font getGuiFont(const std::filesystem::path& path)
+{
+	std::string key = path.string();
+	if (std::shared_ptr<tgui::BackendFont> backendFont = findEntry(guiFonts, key)) {
+		return tgui::Font(backendFont, key);
+	}
+
+	MappedFile file(path);
+	if (!file.isOpen()) {
+		LOG_ERROR << "Failed to load font: " << key;
+		return nullptr;
+	}
+	try {
+		tgui::Font font(file.data(), file.size()); // TGUI keeps its own copy of the data
+		guiFonts[key] = font.getBackendFont();
+		return tgui::Font(font.getBackendFont(), key);
+	}
+	catch (const tgui::Exception& e) {
+		LOG_ERROR << "Failed to load font: " << key << " (" << e.what() << ")";
+	}
+	return nullptr;
+}
+
+std::shared_ptr<const sf::Image> getImage(const std::filesystem::path& path)
+{
+	std::string key = path.string();
+	if (std::shared_ptr<const sf::Image> image = findEntry(images, key)) {
+		return image;
+	}
+
+	MappedFile file(path);
+	auto image = std::make_shared<sf::Image>();
+	bool loaded = file.isOpen() ? image->loadFromMemory(file.data(), file.size()) : image->loadFromFile(path);
+	if (!loaded) {
+		LOG_ERROR << "Failed to load image: " << key;
+		return nullptr;
+	}
+	images[key] = image;
+	return image;
+}
+
+std::shared_ptr<const sf::Texture> getTexture(const std::filesystem::path& path)
+{
+	std::string key = path.string();
+	if (std::shared_ptr<const sf::Texture> texture = findEntry(textures, key)) {
+		return texture;
+	}
+
+	std::shared_ptr<const sf::Image> image = getImage(path);
+	if (!image) {
+		return nullptr;
+	}
+	auto texture = std::make_shared<sf::Texture>();
+	if (!texture->loadFromImage(*image)) {
+		LOG_ERROR << "Failed to create texture: " << key;
+		return nullptr;
+	}
+	texture->setSmooth(true);
+	textures[key] = texture;
+	return texture;
+}
+
+} // namespace ResourceCache
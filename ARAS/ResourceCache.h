@@ -0,0 +1,19 @@
+#pragma once
+#include <filesystem>
+#include <memory>
+#include <SFML/Graphics.hpp>
+#include <TGUI/TGUI.hpp>
+
+// Fonts and images shared by every window. Each file is memory mapped and
+// decoded once, the cache only keeps weak references so an asset is released
+// with the last window using it. GUI thread only. Returns nullptr (or a null
+// tgui::Font) when the file cannot be loaded.
+namespace ResourceCache {
+
+std::shared_ptr<const sf::Font> getFont(const std::filesystem::path& path);
+tgui::Font getGuiFont(const std::filesystem::path& path);
+std::shared_ptr<const sf::Image> getImage(const std::filesystem::path& path);
+// Smoothed texture of the image, for sprites
+std::shared_ptr<const sf::Texture> getTexture(const std::filesystem::path& path);
+
+} // namespace ResourceCache
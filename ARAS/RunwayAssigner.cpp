@@ -0,0 +1,323 @@
+#include "RunwayAssigner.h"
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <algorithm>
+#include <utility>
+
+#include "Logger.h"
+#include "Tracer.h"
+#include "Metrics.h"
+
+using Clock = std::chrono::steady_clock;
+
+static double secondsSince(Clock::time_point start)
+{
+	return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+RunwayAssigner::RunwayAssigner(DataManager& dataManager)
+	: m_dataManager(dataManager)
+{
+}
+
+AssignmentEvent RunwayAssigner::assign(const std::vector<std::string>& firs, const EventHandler& onEvent)
+{
+	return run(firs, onEvent, false);
+}
+
+AssignmentEvent RunwayAssigner::refresh(const std::vector<std::string>& firs, const EventHandler& onEvent)
+{
+	return run(firs, onEvent, true);
+}
+
+AssignmentEvent RunwayAssigner::run(const std::vector<std::string>& firs, const EventHandler& onEvent, bool changedOnly)
+{
+	Clock::time_point start = Clock::now();
+	m_dataManager.resetFetchStats();
+
+	auto sendEvent = [&onEvent](const AssignmentEvent& event) {
+		if (onEvent) {
+			AssignmentEvent copy = event;
+			onEvent(std::move(copy));
+		}
+	};
+
+	std::string label;
+	std::vector<std::string> airports;
+	for (const auto& fir : firs) {
+		label += (label.empty() ? "" : ",") + fir;
+		for (auto& airport : m_dataManager.getAirportsList(fir)) {
+			if (std::find(airports.begin(), airports.end(), airport) == airports.end()) {
+				airports.push_back(std::move(airport));
+			}
+		}
+	}
+
+	AssignmentEvent finished;
+	finished.type = AssignmentEvent::Type::Finished;
+	finished.fir = label;
+
+	if (airports.empty()) {
+		LOG_INFO << "No airports found for FIR: " << label;
+		sendEvent(finished);
+		return finished;
+	}
+
+	std::filesystem::path traceDirectory = m_dataManager.getTraceDirectory();
+	if (!traceDirectory.empty()) {
+		Tracer::instance().beginRun();
+	}
+
+	AssignmentEvent started;
+	started.type = AssignmentEvent::Type::Started;
+	started.fir = label;
+	started.total = airports.size();
+	sendEvent(started);
+
+	// Airports are processed in the order their wind arrives, the output keeps the configured order
+	std::vector<std::vector<std::string>> airportText(airports.size());
+	std::vector<std::string> requested;
+	std::vector<size_t> requestedIndex;
+	size_t completed = 0;
+	AssignmentTimings timings;
+
+	auto sendAirportEvent = [&](size_t i, AssignmentEvent::Type type, const std::string& detail) {
+		AssignmentEvent airportEvent;
+		airportEvent.type = type;
+		airportEvent.fir = label;
+		airportEvent.airport = airports[i];
+		airportEvent.detail = detail;
+		airportEvent.completed = ++completed;
+		airportEvent.total = airports.size();
+		sendEvent(airportEvent);
+	};
+
+	// The same index for the whole cycle, even if the runway data is reloaded meanwhile
+	std::shared_ptr<const RunwayIndex> runwayIndexSnapshot = m_dataManager.getRunwayIndex();
+	const RunwayIndex& runwayIndex = *runwayIndexSnapshot;
+	if (runwayIndexSnapshot != m_lastIndex) {
+		m_lastCycle.clear(); // margins were computed on the previous configurations
+		m_lastIndex = runwayIndexSnapshot;
+	}
+	for (size_t i = 0; i < airports.size(); ++i) {
+		if (runwayIndex.find(airports[i]) == nullptr) {
+			LOG_WARNING << "No runway data for airport: " << airports[i];
+			sendAirportEvent(i, AssignmentEvent::Type::AirportFailed, "no runway data");
+			continue;
+		}
+		requested.push_back(airports[i]);
+		requestedIndex.push_back(i);
+	}
+
+	// Owned by the callback as well, a fetch worker may still be notifying after run() returned
+	struct ReadyQueue {
+		std::mutex mutex;
+		std::condition_variable condition;
+		std::deque<std::pair<size_t, WindData>> winds;
+	};
+	auto ready = std::make_shared<ReadyQueue>();
+	m_dataManager.getWindData(requested, [ready, requestedIndex = std::move(requestedIndex)](size_t index, const WindData& windData) {
+		{
+			std::lock_guard<std::mutex> lock(ready->mutex);
+			ready->winds.emplace_back(requestedIndex[index], windData);
+		}
+		ready->condition.notify_one();
+	});
+
+	// Whatever is ready at the same time (typically all the cached airports) is evaluated in one pass
+	std::vector<std::pair<size_t, WindData>> batch;
+	std::vector<size_t> batchIndex;
+	std::vector<const AirportRunways*> batchAirports;
+	std::vector<WindData> batchWinds;
+	std::vector<RunwaySelection> batchSelections;
+	std::vector<bool> windReceived(airports.size(), false);
+	// With provisional output the first pass takes what is ready without waiting (the cached
+	// airports) and writes what the wind snapshot gives for the airports still being fetched
+	bool provisional = std::exchange(m_provisionalOutput, false);
+	for (size_t received = 0; received < requested.size(); received += batch.size()) {
+		Clock::time_point waitStart = Clock::now();
+		{
+			TRACE_SCOPE("wait wind");
+			std::unique_lock<std::mutex> lock(ready->mutex);
+			ready->condition.wait(lock, [&] { return provisional || !ready->winds.empty(); });
+			batch.assign(ready->winds.begin(), ready->winds.end());
+			ready->winds.clear();
+		}
+		timings.fetch += secondsSince(waitStart);
+
+		Clock::time_point selectStart = Clock::now();
+		batchIndex.clear();
+		batchAirports.clear();
+		batchWinds.clear();
+		for (const auto& [i, windData] : batch) {
+			windReceived[i] = true;
+			LOG_DEBUG << "Processing airport: " << airports[i];
+			if (windData.windDirection == -1 || windData.windSpeed == -1) {
+				LOG_WARNING << "Invalid wind data for airport: " << airports[i];
+				sendAirportEvent(i, AssignmentEvent::Type::AirportFailed, "no wind data");
+				continue;
+			}
+			if (windData.stale) {
+				LOG_WARNING << "[STALE] Assigning " << airports[i] << " from last known wind data.";
+			}
+			auto previous = m_lastCycle.find(airports[i]);
+			if (changedOnly && previous != m_lastCycle.end()) {
+				// Small slack for the float trig tables
+				float distance = RunwaySelector::windDistance(previous->second.windData, windData);
+				if (distance + 0.01f < previous->second.margin) {
+					const RunwayData& runwayData = previous->second.runwayData;
+					airportText[i] = formatActiveAirport(airports[i]);
+					std::vector<std::string> assignedRunwayStrings = formatRunwayOutput(runwayData);
+					airportText[i].insert(airportText[i].end(), assignedRunwayStrings.begin(), assignedRunwayStrings.end());
+					sendAirportEvent(i, AssignmentEvent::Type::AirportAssigned, runwayData.depRunway + "/" + runwayData.arrRunway + " (unchanged)");
+					continue;
+				}
+			}
+			batchIndex.push_back(i);
+			batchAirports.push_back(runwayIndex.find(airports[i]));
+			batchWinds.push_back(windData);
+		}
+
+		batchSelections.resize(batchAirports.size());
+		{
+			TRACE_SCOPE("selectBatch", std::to_string(batchAirports.size()) + " airports");
+			RunwaySelector::selectBatch(runwayIndex, batchAirports, batchWinds, batchSelections);
+		}
+		timings.select += secondsSince(selectStart);
+
+		Clock::time_point formatStart = Clock::now();
+		for (size_t b = 0; b < batchIndex.size(); ++b) {
+			size_t i = batchIndex[b];
+			const RunwaySelection& selection = batchSelections[b];
+			const RunwayConfig& config = runwayIndex.getConfigs(*batchAirports[b])[selection.configIndex];
+			RunwayData runwayData = runwayIndex.toRunwayData(airports[i], *batchAirports[b], config);
+			float margin = RunwaySelector::decisionMargin(runwayIndex.getConfigs(*batchAirports[b]), batchWinds[b], selection);
+			m_lastCycle[airports[i]] = AirportState{ batchWinds[b], runwayData, margin };
+			++finished.reselected;
+			if (!selection.withinLimits) {
+				LOG_WARNING << "No configuration within limits for " << airports[i] << ", using " << runwayData.depRunway
+					<< " (tailwind " << selection.components.gustTailwind << " kt).";
+			}
+
+			airportText[i] = formatActiveAirport(airports[i]);
+			std::vector<std::string> assignedRunwayStrings = formatRunwayOutput(runwayData);
+			airportText[i].insert(airportText[i].end(), assignedRunwayStrings.begin(), assignedRunwayStrings.end());
+
+			sendAirportEvent(i, AssignmentEvent::Type::AirportAssigned, runwayData.depRunway + "/" + runwayData.arrRunway + (batchWinds[b].stale ? " (stale)" : ""));
+		}
+		timings.format += secondsSince(formatStart);
+
+		if (provisional) {
+			provisional = false;
+			if (received + batch.size() < requested.size()) {
+				finished.rwyChanged = outputProvisional(airports, airportText, windReceived);
+			}
+		}
+	}
+
+	Clock::time_point outputStart = Clock::now();
+	std::vector<std::string> runwayText;
+	for (const auto& text : airportText) {
+		runwayText.insert(runwayText.end(), text.begin(), text.end());
+	}
+
+	// outputRunways compares with the file itself, which may have moved or been edited since the last cycle
+	DataManager::RwyWrite write = m_dataManager.outputRunways(runwayText);
+	finished.success = write != DataManager::RwyWrite::Failed;
+	finished.rwyChanged = finished.rwyChanged || write == DataManager::RwyWrite::Written;
+	m_dataManager.saveWindSnapshot();
+	timings.output = secondsSince(outputStart);
+	timings.total = secondsSince(start);
+	(changedOnly ? Metrics::instance().refreshSeconds : Metrics::instance().assignSeconds).observe(timings.total);
+	LOG_INFO << "Runway assignment completed in " << timings.total << " seconds, " << finished.reselected << " of "
+		<< airports.size() << " airports reselected.";
+
+	HttpClientPool::Stats fetchStats = m_dataManager.getFetchStats();
+	LOG_INFO << "METAR connections: " << fetchStats.reused << " reused, " << fetchStats.opened << " opened ("
+		<< fetchStats.resumed << " TLS sessions resumed) for " << fetchStats.requests << " requests, "
+		<< m_dataManager.getCacheHits() << " airports served from cache.";
+
+	finished.completed = airports.size();
+	finished.total = airports.size();
+	finished.seconds = timings.total;
+	finished.timings = timings;
+	sendEvent(finished);
+	if (!traceDirectory.empty()) {
+		Tracer::instance().endRun(changedOnly ? "refresh" : "assign", label, traceDirectory);
+	}
+	return finished;
+}
+
+bool RunwayAssigner::outputProvisional(const std::vector<std::string>& airports, const std::vector<std::vector<std::string>>& airportText,
+	const std::vector<bool>& windReceived)
+{
+	TRACE_SCOPE("outputProvisional");
+	std::vector<std::string> runwayText;
+	size_t fromSnapshot = 0;
+	for (size_t i = 0; i < airports.size(); ++i) {
+		if (windReceived[i]) {
+			runwayText.insert(runwayText.end(), airportText[i].begin(), airportText[i].end());
+			continue;
+		}
+		WindData lastKnown{};
+		if (!m_dataManager.getLastKnownWind(airports[i], lastKnown)) {
+			continue;
+		}
+		RunwayData runwayData = assignAirportRunway(airports[i], lastKnown);
+		if (runwayData.depRunway.empty()) {
+			continue; // no runway data
+		}
+		LOG_WARNING << "[STALE] Assigning " << airports[i] << " from the wind snapshot until its METAR arrives.";
+		std::vector<std::string> active = formatActiveAirport(airports[i]);
+		std::vector<std::string> assigned = formatRunwayOutput(runwayData);
+		runwayText.insert(runwayText.end(), active.begin(), active.end());
+		runwayText.insert(runwayText.end(), assigned.begin(), assigned.end());
+		++fromSnapshot;
+	}
+	if (fromSnapshot == 0) {
+		return false;
+	}
+	LOG_INFO << "Provisional runways written for " << fromSnapshot << " airports, waiting for fresh METARs.";
+	return m_dataManager.outputRunways(runwayText) == DataManager::RwyWrite::Written;
+}
+
+RunwayData RunwayAssigner::assignAirportRunway(const std::string& airport, const WindData& windData) const
+{
+	TRACE_SCOPE("assignAirportRunway", airport);
+	// Add connected airports logic
+	std::shared_ptr<const RunwayIndex> runwayIndex = m_dataManager.getRunwayIndex();
+	const AirportRunways* airportRunways = runwayIndex->find(airport);
+	if (airportRunways == nullptr) {
+		RunwayData runwayData;
+		runwayData.airport = airport;
+		return runwayData;
+	}
+	std::span<const RunwayConfig> configs = runwayIndex->getConfigs(*airportRunways);
+	RunwaySelection selection = RunwaySelector::select(configs, windData);
+	return runwayIndex->toRunwayData(airport, *airportRunways, configs[selection.configIndex]);
+}
+
+std::vector<std::string> RunwayAssigner::formatRunwayOutput(const RunwayData& runwaysData)
+{
+	TRACE_SCOPE("formatRunwayOutput", runwaysData.airport);
+	std::string standardOutput = "ACTIVE_RUNWAY:" + runwaysData.airport + ":";
+	std::vector<std::string> output;
+
+	output.emplace_back(standardOutput + runwaysData.depRunway + ":1");
+	output.emplace_back(standardOutput + runwaysData.arrRunway + ":0");
+
+	if (runwaysData.has4rwys) {
+		output.emplace_back(standardOutput + runwaysData.depRunwayBis + ":1");
+		output.emplace_back(standardOutput + runwaysData.arrRunwayBis + ":0");
+	}
+
+	return output;
+}
+
+std::vector<std::string> RunwayAssigner::formatActiveAirport(const std::string& airport)
+{
+	std::string activeAirportText = "ACTIVE_AIRPORT:" + airport + ":";
+	return std::vector<std::string>{activeAirportText + "1", activeAirportText + "0"};
+}
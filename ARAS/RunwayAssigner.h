@@ -0,0 +1,86 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <functional>
+#include <unordered_map>
+#include <memory>
+
+#include "DataManager.h"
+#include "RunwaySelector.h"
+
+// Seconds spent in each phase of an assignment. Wind fetching overlaps the
+// other phases, "fetch" only counts the time spent waiting for it.
+struct AssignmentTimings {
+	double fetch = 0.0;
+	double select = 0.0;
+	double format = 0.0;
+	double output = 0.0;
+	double total = 0.0;
+};
+
+// Progress of a runway assignment, consumed on the GUI thread
+struct AssignmentEvent {
+	enum class Type {
+		Started,
+		AirportAssigned,
+		AirportFailed,
+		Finished
+	};
+
+	Type type = Type::Started;
+	std::string fir;
+	std::string airport;
+	std::string detail;
+	size_t completed = 0;
+	size_t total = 0;
+	bool success = false;
+	double seconds = 0.0;
+	// Finished only
+	AssignmentTimings timings;
+	size_t reselected = 0; // airports whose configuration was evaluated again
+	bool rwyChanged = false; // false when the .rwy file already had this content
+};
+
+// Platform independent part of an assignment: wind, runway selection and the
+// EuroScope .rwy text. Shared by the GUI and aras-cli. Keeps the result of the
+// previous cycle, one assignment at a time.
+class RunwayAssigner {
+public:
+	using EventHandler = std::function<void(AssignmentEvent&&)>;
+
+	explicit RunwayAssigner(DataManager& dataManager);
+
+	// Assigns every airport of the FIRs and writes the .rwy file. Events are
+	// sent from the calling thread, the Finished one is also returned.
+	AssignmentEvent assign(const std::vector<std::string>& firs, const EventHandler& onEvent = nullptr);
+	// Periodic version of assign: airports whose wind did not move past their
+	// decision margin keep their previous runways, and the .rwy file is only
+	// rewritten when its content changes.
+	AssignmentEvent refresh(const std::vector<std::string>& firs, const EventHandler& onEvent = nullptr);
+	// For the next assignment only: the airports still being fetched get a first .rwy
+	// file from the wind snapshot, rewritten once their METARs arrive
+	void setProvisionalOutput(bool enabled) { m_provisionalOutput = enabled; }
+
+	RunwayData assignAirportRunway(const std::string& airport, const WindData& windData) const;
+	static std::vector<std::string> formatRunwayOutput(const RunwayData& runwayData);
+	static std::vector<std::string> formatActiveAirport(const std::string& airport);
+
+private:
+	struct AirportState {
+		WindData windData; // wind the margin was computed for
+		RunwayData runwayData;
+		float margin = 0.f;
+	};
+
+	AssignmentEvent run(const std::vector<std::string>& firs, const EventHandler& onEvent, bool changedOnly);
+	// Writes the .rwy file with the last known wind of the airports whose METAR is still
+	// being fetched, so a restart has runways before the network answers
+	bool outputProvisional(const std::vector<std::string>& airports, const std::vector<std::vector<std::string>>& airportText,
+		const std::vector<bool>& windReceived);
+
+private:
+	DataManager& m_dataManager;
+	std::unordered_map<std::string, AirportState> m_lastCycle;
+	std::shared_ptr<const RunwayIndex> m_lastIndex; // index m_lastCycle was selected with
+	bool m_provisionalOutput = false;
+};
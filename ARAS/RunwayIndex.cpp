@@ -0,0 +1,206 @@
+#include "RunwayIndex.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+
+#include "Logger.h"
+
+static uint32_t hashIcao(uint32_t id) {
+	uint32_t hash = id * 2654435761u; // Knuth multiplicative hash, high bits folded in for the mask
+	return hash ^ (hash >> 15);
+}
+
+// Variants are named "1", "2", ... by preference, but json objects iterate in
+// lexical order which would put "10" before "2"
+static bool variantLess(const std::string& a, const std::string& b) {
+	int aValue = 0, bValue = 0;
+	auto aResult = std::from_chars(a.data(), a.data() + a.size(), aValue);
+	auto bResult = std::from_chars(b.data(), b.data() + b.size(), bValue);
+	bool aNumeric = aResult.ec == std::errc() && aResult.ptr == a.data() + a.size();
+	bool bNumeric = bResult.ec == std::errc() && bResult.ptr == b.data() + b.size();
+	if (aNumeric && bNumeric) return aValue < bValue;
+	if (aNumeric != bNumeric) return aNumeric;
+	return a < b;
+}
+
+bool RunwayIndex::build(const nlohmann::json& rwyDataJson)
+{
+	clear();
+	if (!rwyDataJson.is_object()) {
+		LOG_ERROR << "Invalid rwyData format.";
+		return false;
+	}
+
+	m_airports.reserve(rwyDataJson.size());
+	m_configs.reserve(rwyDataJson.size() * 2);
+
+	for (const auto& [oaci, airportJson] : rwyDataJson.items()) {
+		uint32_t id = packIcao(oaci);
+		if (id == 0 || !airportJson.is_object() || !airportJson.contains("runways") || !airportJson["runways"].is_object()) {
+			LOG_WARNING << "Skipping invalid rwyData entry: " << oaci;
+			continue;
+		}
+		if (find(oaci) != nullptr) {
+			continue;
+		}
+
+		AirportRunways airport;
+		airport.id = id;
+		airport.firstConfig = static_cast<uint32_t>(m_configs.size());
+		airport.has4rwys = airportJson.contains("has4runways");
+
+		const nlohmann::json& runwaysJson = airportJson["runways"];
+		std::vector<std::string> variants;
+		variants.reserve(runwaysJson.size());
+		for (auto it = runwaysJson.begin(); it != runwaysJson.end(); ++it) {
+			variants.push_back(it.key());
+		}
+		std::sort(variants.begin(), variants.end(), variantLess);
+
+		for (const auto& variant : variants) {
+			const nlohmann::json& configJson = runwaysJson[variant];
+			RunwayConfig config;
+			try {
+				config.preferential = configJson.value("preferential", 0);
+				bool valid = readHeadings(configJson.value("heading", nlohmann::json()), config)
+					&& copyName(configJson.value("departure", nlohmann::json()), config.depRunway)
+					&& copyName(configJson.value("arrival", nlohmann::json()), config.arrRunway);
+				if (airport.has4rwys) {
+					valid = valid && copyName(configJson.value("departureBis", nlohmann::json()), config.depRunwayBis)
+						&& copyName(configJson.value("arrivalBis", nlohmann::json()), config.arrRunwayBis);
+				}
+				if (!valid) {
+					LOG_WARNING << "Skipping invalid runway configuration " << variant << " of " << oaci;
+					continue;
+				}
+			}
+			catch (const std::exception& e) {
+				LOG_WARNING << "Error parsing runway configuration " << variant << " of " << oaci << ": " << e.what();
+				continue;
+			}
+			m_configs.push_back(config);
+			++airport.configCount;
+		}
+
+		if (airport.configCount == 0) {
+			continue;
+		}
+		m_airports.push_back(airport);
+		buildSlots();
+	}
+
+	return true;
+}
+
+void RunwayIndex::clear()
+{
+	m_airports.clear();
+	m_configs.clear();
+	m_slots.clear();
+	m_slotMask = 0;
+}
+
+const AirportRunways* RunwayIndex::find(std::string_view oaci) const
+{
+	uint32_t id = packIcao(oaci);
+	if (id == 0 || m_slots.empty()) {
+		return nullptr;
+	}
+	for (uint32_t slot = hashIcao(id) & m_slotMask; m_slots[slot] != 0; slot = (slot + 1) & m_slotMask) {
+		const AirportRunways& airport = m_airports[m_slots[slot] - 1];
+		if (airport.id == id) {
+			return &airport;
+		}
+	}
+	return nullptr;
+}
+
+std::span<const RunwayConfig> RunwayIndex::getConfigs(const AirportRunways& airport) const
+{
+	return std::span<const RunwayConfig>(m_configs.data() + airport.firstConfig, airport.configCount);
+}
+
+RunwayData RunwayIndex::toRunwayData(std::string_view oaci, const AirportRunways& airport, const RunwayConfig& config) const
+{
+	RunwayData runwayData;
+	runwayData.airport = oaci;
+	runwayData.has4rwys = airport.has4rwys;
+	runwayData.depRunway = RunwayConfig::view(config.depRunway);
+	runwayData.arrRunway = RunwayConfig::view(config.arrRunway);
+	runwayData.depRunwayBis = RunwayConfig::view(config.depRunwayBis);
+	runwayData.arrRunwayBis = RunwayConfig::view(config.arrRunwayBis);
+	runwayData.heading = config.heading;
+	runwayData.preferential = config.preferential;
+	return runwayData;
+}
+
+uint32_t RunwayIndex::packIcao(std::string_view oaci)
+{
+	if (oaci.size() != 4) {
+		return 0;
+	}
+	uint32_t id = 0;
+	for (char c : oaci) {
+		if (!std::isalnum(static_cast<unsigned char>(c))) {
+			return 0;
+		}
+		id = (id << 8) | static_cast<uint8_t>(std::toupper(static_cast<unsigned char>(c)));
+	}
+	return id;
+}
+
+bool RunwayIndex::copyName(const nlohmann::json& value, RunwayConfig::Name& name)
+{
+	if (!value.is_string()) {
+		return false;
+	}
+	const std::string& text = value.get_ref<const std::string&>();
+	if (text.empty() || text.size() >= name.size()) {
+		return false;
+	}
+	name.fill('\0');
+	std::copy(text.begin(), text.end(), name.begin());
+	return true;
+}
+
+bool RunwayIndex::readHeadings(const nlohmann::json& value, RunwayConfig& config)
+{
+	config.headingCount = 0;
+	if (value.is_number()) {
+		config.headings[config.headingCount++] = static_cast<int16_t>(value.get<int>() % 360);
+	}
+	else if (value.is_array()) {
+		for (const auto& heading : value) {
+			if (!heading.is_number() || config.headingCount == RunwayConfig::maxHeadings) {
+				return false;
+			}
+			config.headings[config.headingCount++] = static_cast<int16_t>(heading.get<int>() % 360);
+		}
+	}
+	if (config.headingCount == 0) {
+		return false;
+	}
+	config.heading = config.headings[0];
+	return true;
+}
+
+void RunwayIndex::buildSlots()
+{
+	// Keep the load factor under 1/2
+	size_t capacity = m_slots.size();
+	if (capacity < m_airports.size() * 2) {
+		capacity = 16;
+		while (capacity < m_airports.size() * 2) capacity <<= 1;
+		m_slots.assign(capacity, 0);
+		m_slotMask = static_cast<uint32_t>(capacity - 1);
+		for (uint32_t i = 0; i + 1 < m_airports.size(); ++i) {
+			uint32_t slot = hashIcao(m_airports[i].id) & m_slotMask;
+			while (m_slots[slot] != 0) slot = (slot + 1) & m_slotMask;
+			m_slots[slot] = i + 1;
+		}
+	}
+	uint32_t last = static_cast<uint32_t>(m_airports.size() - 1);
+	uint32_t slot = hashIcao(m_airports[last].id) & m_slotMask;
+	while (m_slots[slot] != 0) slot = (slot + 1) & m_slotMask;
+	m_slots[slot] = last + 1;
+}
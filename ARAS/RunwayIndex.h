@@ -0,0 +1,73 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <array>
+#include <span>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+
+struct RunwayData {
+	std::string airport;
+	bool has4rwys = false;
+	std::string depRunway;
+	std::string arrRunway;
+	std::string depRunwayBis;
+	std::string arrRunwayBis;
+	int heading = 0;
+	int preferential = 0;
+};
+
+// One runway configuration of rwydata.json, runway names stored inline
+struct RunwayConfig {
+	using Name = std::array<char, 8>; // NUL padded, EuroScope names are at most 3 chars
+
+	static constexpr size_t maxHeadings = 4;
+
+	Name depRunway{};
+	Name arrRunway{};
+	Name depRunwayBis{};
+	Name arrRunwayBis{};
+	int heading = 0; // first heading, kept for RunwayData
+	int preferential = 0; // tailwind tolerated before leaving this configuration, in kt
+	std::array<int16_t, maxHeadings> headings{}; // every runway in use, "heading" may be a list
+	uint8_t headingCount = 0;
+
+	static std::string_view view(const Name& name) { return std::string_view(name.data()); }
+};
+
+struct AirportRunways {
+	uint32_t id = 0; // packed ICAO
+	uint32_t firstConfig = 0;
+	uint32_t configCount = 0;
+	bool has4rwys = false;
+};
+
+// rwydata.json compiled once into contiguous tables. Lookups are O(1) and do
+// not allocate, unknown airports are simply not found.
+class RunwayIndex {
+public:
+	bool build(const nlohmann::json& rwyDataJson);
+	void clear();
+
+	const AirportRunways* find(std::string_view oaci) const;
+	std::span<const RunwayConfig> getConfigs(const AirportRunways& airport) const;
+	RunwayData toRunwayData(std::string_view oaci, const AirportRunways& airport, const RunwayConfig& config) const;
+
+	size_t airportCount() const { return m_airports.size(); }
+	size_t configCount() const { return m_configs.size(); }
+
+	// "LFPG" -> 'L' << 24 | 'F' << 16 | 'P' << 8 | 'G', 0 if not a 4 letter code
+	static uint32_t packIcao(std::string_view oaci);
+
+private:
+	static bool copyName(const nlohmann::json& value, RunwayConfig::Name& name);
+	static bool readHeadings(const nlohmann::json& value, RunwayConfig& config);
+	void buildSlots();
+
+private:
+	std::vector<AirportRunways> m_airports;
+	std::vector<RunwayConfig> m_configs;
+	std::vector<uint32_t> m_slots; // open addressing, airport index + 1, 0 = empty
+	uint32_t m_slotMask = 0;
+};
@@ -0,0 +1,177 @@
+#include "RunwaySelector.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <limits>
+
+#include "TrigTable.h"
+#include "WindKernel.h"
+
+WindComponents RunwaySelector::computeComponents(const RunwayConfig& config, const WindData& windData)
+{
+	WindComponents components;
+	float speed = static_cast<float>(std::max(windData.windSpeed, 0));
+	float gust = std::max(speed, static_cast<float>(windData.windGust));
+
+	if (windData.windDirection == 0) {
+		// Variable or calm, any runway may get the whole wind from behind
+		components.headwind = -speed;
+		components.tailwind = speed;
+		components.crosswind = speed;
+		components.gustTailwind = gust;
+		components.gustCrosswind = gust;
+		return components;
+	}
+
+	bool first = true;
+	for (uint8_t i = 0; i < config.headingCount; ++i) {
+		int angle = windData.windDirection - config.headings[i];
+		float along = TrigTable::cosDeg(angle);
+		float across = std::abs(TrigTable::sinDeg(angle));
+
+		float headwind = speed * along;
+		float crosswind = speed * across;
+		float gustTailwind = std::max(-gust * along, 0.f);
+		float gustCrosswind = gust * across;
+
+		if (first) {
+			components.headwind = headwind;
+			components.crosswind = crosswind;
+			components.gustTailwind = gustTailwind;
+			components.gustCrosswind = gustCrosswind;
+			first = false;
+		}
+		else {
+			components.headwind = std::min(components.headwind, headwind);
+			components.crosswind = std::max(components.crosswind, crosswind);
+			components.gustTailwind = std::max(components.gustTailwind, gustTailwind);
+			components.gustCrosswind = std::max(components.gustCrosswind, gustCrosswind);
+		}
+	}
+	components.tailwind = std::max(-components.headwind, 0.f);
+	return components;
+}
+
+RunwaySelection RunwaySelector::select(std::span<const RunwayConfig> configs, const WindData& windData)
+{
+	RunwaySelection best;
+	if (configs.empty()) {
+		return best;
+	}
+
+	for (uint32_t i = 0; i < configs.size(); ++i) {
+		WindComponents components = computeComponents(configs[i], windData);
+		if (components.gustTailwind <= static_cast<float>(configs[i].preferential)) {
+			best.configIndex = i;
+			best.withinLimits = true;
+			best.components = components;
+			return best;
+		}
+
+		// Nothing accepted so far, keep the least bad one
+		const WindComponents& current = best.components;
+		bool better = i == 0
+			|| components.gustTailwind < current.gustTailwind
+			|| (components.gustTailwind == current.gustTailwind && components.headwind > current.headwind)
+			|| (components.gustTailwind == current.gustTailwind && components.headwind == current.headwind && components.crosswind < current.crosswind);
+		if (better) {
+			best.configIndex = i;
+			best.components = components;
+		}
+	}
+	return best;
+}
+
+float RunwaySelector::decisionMargin(std::span<const RunwayConfig> configs, const WindData& windData, const RunwaySelection& selection)
+{
+	if (selection.configIndex >= configs.size()) {
+		return 0.f;
+	}
+
+	float margin = std::numeric_limits<float>::infinity();
+	float secondGustTailwind = std::numeric_limits<float>::infinity();
+	for (uint32_t i = 0; i < configs.size(); ++i) {
+		float gustTailwind = computeComponents(configs[i], windData).gustTailwind;
+		float slack = static_cast<float>(configs[i].preferential) - gustTailwind;
+		if (selection.withinLimits) {
+			// The chosen one has to keep qualifying, the ones tried before it have to keep failing
+			if (i == selection.configIndex) {
+				margin = std::min(margin, slack);
+				break;
+			}
+			margin = std::min(margin, -slack);
+		}
+		else {
+			margin = std::min(margin, -slack);
+			if (i != selection.configIndex) {
+				secondGustTailwind = std::min(secondGustTailwind, gustTailwind);
+			}
+		}
+	}
+	if (!selection.withinLimits) {
+		// Both the best and the runner-up may move toward each other
+		margin = std::min(margin, (secondGustTailwind - selection.components.gustTailwind) / 2.f);
+	}
+	return std::max(margin, 0.f);
+}
+
+float RunwaySelector::windDistance(const WindData& a, const WindData& b)
+{
+	auto gustSpeed = [](const WindData& windData) {
+		return std::max(static_cast<float>(std::max(windData.windSpeed, 0)), static_cast<float>(windData.windGust));
+	};
+	bool aVariable = a.windDirection == 0;
+	bool bVariable = b.windDirection == 0;
+	if (aVariable != bVariable) {
+		return std::numeric_limits<float>::infinity();
+	}
+	if (aVariable) {
+		return std::abs(gustSpeed(a) - gustSpeed(b));
+	}
+	float dx = gustSpeed(a) * TrigTable::sinDeg(a.windDirection) - gustSpeed(b) * TrigTable::sinDeg(b.windDirection);
+	float dy = gustSpeed(a) * TrigTable::cosDeg(a.windDirection) - gustSpeed(b) * TrigTable::cosDeg(b.windDirection);
+	return std::sqrt(dx * dx + dy * dy);
+}
+
+void RunwaySelector::selectBatch(const RunwayIndex& index, std::span<const AirportRunways* const> airports,
+	std::span<const WindData> winds, std::span<RunwaySelection> selections)
+{
+	size_t count = std::min({ airports.size(), winds.size(), selections.size() });
+	if (count < kernelMinBatch) {
+		for (size_t i = 0; i < count; ++i) {
+			if (airports[i] == nullptr) {
+				selections[i] = RunwaySelection{};
+				continue;
+			}
+			selections[i] = select(index.getConfigs(*airports[i]), winds[i]);
+		}
+		return;
+	}
+
+	WindKernelTable table = WindKernel::buildTable(index, airports.first(count));
+	std::vector<int32_t> directions(count);
+	std::vector<float> speeds(count);
+	std::vector<float> gusts(count);
+	for (size_t i = 0; i < count; ++i) {
+		// Keep 360 apart from 0, which means VRB
+		int direction = TrigTable::normalize(winds[i].windDirection);
+		directions[i] = direction == 0 && winds[i].windDirection != 0 ? 360 : direction;
+		speeds[i] = static_cast<float>(winds[i].windSpeed);
+		gusts[i] = static_cast<float>(winds[i].windGust);
+	}
+	std::vector<int32_t> configIndex(count);
+	WindKernel::selectConfigs(table, directions, speeds, gusts, configIndex);
+
+	// The kernel only returns the configuration, components are needed for the report
+	for (size_t i = 0; i < count; ++i) {
+		if (airports[i] == nullptr) {
+			selections[i] = RunwaySelection{};
+			continue;
+		}
+		const RunwayConfig& config = index.getConfigs(*airports[i])[configIndex[i]];
+		RunwaySelection& selection = selections[i];
+		selection.configIndex = static_cast<uint32_t>(configIndex[i]);
+		selection.components = computeComponents(config, winds[i]);
+		selection.withinLimits = selection.components.gustTailwind <= static_cast<float>(config.preferential);
+	}
+}
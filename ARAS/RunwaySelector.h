@@ -0,0 +1,48 @@
+#pragma once
+#include <span>
+#include <cstdint>
+
+#include "WindData.h"
+#include "RunwayIndex.h"
+
+// Wind relative to one runway configuration, worst case over its runways.
+// Tailwinds are positive, gust values use the gust speed when it is reported.
+struct WindComponents {
+	float headwind = 0.f;
+	float tailwind = 0.f;
+	float crosswind = 0.f;
+	float gustTailwind = 0.f;
+	float gustCrosswind = 0.f;
+};
+
+struct RunwaySelection {
+	uint32_t configIndex = 0; // index into the airport's configurations
+	bool withinLimits = false; // false when no configuration accepted the wind
+	WindComponents components;
+};
+
+// Picks a runway configuration for a given wind.
+//  - Configurations are tried in rwydata.json order, the first one whose gust
+//    tailwind does not exceed its "preferential" value is used.
+//  - When none qualifies, the one with the least gust tailwind wins, then the
+//    most headwind, then the least crosswind, then the most preferred.
+// A direction of 0 with wind means VRB (AVWX reports north as 360), it is
+// treated as a tailwind on every runway.
+class RunwaySelector {
+public:
+	static WindComponents computeComponents(const RunwayConfig& config, const WindData& windData);
+	static RunwaySelection select(std::span<const RunwayConfig> configs, const WindData& windData);
+
+	// Gust tailwinds move at most as much as the gust vector (speed along the
+	// direction), so any wind closer than this margin to windData, in kt, gets
+	// the same selection. 0 when the selection was decided by a tie.
+	static float decisionMargin(std::span<const RunwayConfig> configs, const WindData& windData, const RunwaySelection& selection);
+	// Distance between the gust vectors of two winds, infinite when only one of them is VRB
+	static float windDistance(const WindData& a, const WindData& b);
+
+	// Evaluates a whole FIR at once, airports[i] may be null for airports without runway data.
+	// From kernelMinBatch airports on the work is done by WindKernel.
+	static constexpr size_t kernelMinBatch = 16;
+	static void selectBatch(const RunwayIndex& index, std::span<const AirportRunways* const> airports,
+		std::span<const WindData> winds, std::span<RunwaySelection> selections);
+};
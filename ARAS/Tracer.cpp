@@ -0,0 +1,180 @@
+#include "Tracer.h"
+#include <algorithm>
+#include <cctype>
+#include <system_error>
+#include <nlohmann/json.hpp>
+
+#include "AtomicFile.h"
+#include "Logger.h"
+#include "DiagnosticsUtil.h"
+
+namespace {
+
+thread_local ThreadBufferHolder t_buffer;
+
+double toMicroseconds(Tracer::Clock::duration duration)
+{
+	return std::chrono::duration<double, std::micro>(duration).count();
+}
+
+std::string fileTime()
+{
+	std::string time;
+	auto now = std::chrono::system_clock::now();
+	appendUtcTime(std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count(), "%Y%m%d-%H%M%S", "%03d", time);
+	return time;
+}
+
+// "20250115-143000123-assign.json": fileTime(), the run name, nothing else in the directory is ours
+bool isTraceFile(const std::filesystem::path& path)
+{
+	std::string name = path.filename().string();
+	const std::string extension = ".json";
+	constexpr size_t timeSize = 19; // with the dash after it
+	if (name.size() <= timeSize + extension.size() || name.compare(name.size() - extension.size(), extension.size(), extension) != 0) {
+		return false;
+	}
+	for (size_t i = 0; i < timeSize; ++i) {
+		bool dash = i == 8 || i == timeSize - 1;
+		if (dash ? name[i] != '-' : !std::isdigit(static_cast<unsigned char>(name[i]))) {
+			return false;
+		}
+	}
+	for (size_t i = timeSize; i < name.size() - extension.size(); ++i) {
+		if (!std::islower(static_cast<unsigned char>(name[i]))) {
+			return false;
+		}
+	}
+	return true;
+}
+
+} // namespace
+
+Tracer& Tracer::instance()
+{
+	static Tracer tracer;
+	return tracer;
+}
+
+void Tracer::beginRun()
+{
+	std::lock_guard<std::mutex> lock(m_buffersMutex);
+	for (auto it = m_buffers.begin(); it != m_buffers.end();) {
+		ThreadBuffer& buffer = **it;
+		if (buffer.closed.load(std::memory_order_acquire)) {
+			it = m_buffers.erase(it);
+			continue;
+		}
+		std::lock_guard<std::mutex> bufferLock(buffer.mutex);
+		buffer.events.clear();
+		++it;
+	}
+	m_runStart = Clock::now();
+	m_recording.store(true, std::memory_order_release);
+}
+
+bool Tracer::endRun(const std::string& name, const std::string& detail, const std::filesystem::path& directory, int maxFiles)
+{
+	if (!m_recording.load(std::memory_order_acquire)) {
+		return false;
+	}
+	record(name.c_str(), detail, m_runStart, Clock::now());
+	m_recording.store(false, std::memory_order_release);
+
+	nlohmann::json events = nlohmann::json::array();
+	{
+		std::lock_guard<std::mutex> lock(m_buffersMutex);
+		for (const auto& bufferPtr : m_buffers) {
+			ThreadBuffer& buffer = *bufferPtr;
+			std::lock_guard<std::mutex> bufferLock(buffer.mutex);
+			if (buffer.events.empty()) {
+				continue;
+			}
+			std::string trackName = buffer.name.empty() ? "Thread " + std::to_string(buffer.thread) : buffer.name;
+			events.push_back({ {"ph", "M"}, {"name", "thread_name"}, {"pid", 1}, {"tid", buffer.thread}, {"args", {{"name", trackName}}} });
+			events.push_back({ {"ph", "M"}, {"name", "thread_sort_index"}, {"pid", 1}, {"tid", buffer.thread}, {"args", {{"sort_index", buffer.thread}}} });
+			for (const Event& event : buffer.events) {
+				nlohmann::json traceEvent = {
+					{"ph", "X"},
+					{"name", event.name},
+					{"cat", "aras"},
+					{"pid", 1},
+					{"tid", buffer.thread},
+					{"ts", toMicroseconds(event.start - m_runStart)},
+					{"dur", toMicroseconds(event.end - event.start)}
+				};
+				if (!event.detail.empty()) {
+					traceEvent["args"] = { {"detail", event.detail} };
+				}
+				events.push_back(std::move(traceEvent));
+			}
+			buffer.events.clear();
+		}
+	}
+	events.push_back({ {"ph", "M"}, {"name", "process_name"}, {"pid", 1}, {"args", {{"name", "ARAS"}}} });
+
+	std::error_code error;
+	std::filesystem::create_directories(directory, error);
+	std::filesystem::path file = directory / (fileTime() + "-" + name + ".json");
+	nlohmann::json trace = { {"traceEvents", std::move(events)}, {"displayTimeUnit", "ms"} };
+	if (!AtomicFile::write(file, trace.dump())) {
+		LOG_ERROR << "Failed to write trace " << file.string();
+		return false;
+	}
+	LOG_INFO << "Trace written to " << file.string();
+	pruneTraces(directory, maxFiles);
+	return true;
+}
+
+void Tracer::record(const char* name, const std::string& detail, Clock::time_point start, Clock::time_point end)
+{
+	if (!isRecording()) {
+		return;
+	}
+	ThreadBuffer& buffer = threadBuffer();
+	std::lock_guard<std::mutex> lock(buffer.mutex);
+	buffer.events.push_back({ name, detail, start, end });
+}
+
+void Tracer::setThreadName(const std::string& name)
+{
+	ThreadBuffer& buffer = instance().threadBuffer();
+	std::lock_guard<std::mutex> lock(buffer.mutex);
+	buffer.name = name;
+}
+
+Tracer::ThreadBuffer& Tracer::threadBuffer()
+{
+	if (t_buffer.buffer) {
+		return *static_cast<ThreadBuffer*>(t_buffer.buffer.get());
+	}
+	auto buffer = std::make_shared<ThreadBuffer>();
+	buffer->thread = m_nextThread.fetch_add(1, std::memory_order_relaxed);
+	{
+		std::lock_guard<std::mutex> lock(m_buffersMutex);
+		m_buffers.push_back(buffer);
+	}
+	t_buffer.closed = &buffer->closed;
+	t_buffer.buffer = buffer;
+	return *buffer;
+}
+
+void Tracer::pruneTraces(const std::filesystem::path& directory, int maxFiles)
+{
+	// Trace names start with their UTC time, name order is age order
+	std::error_code error;
+	std::vector<std::filesystem::path> traces;
+	for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+		if (isTraceFile(entry.path())) {
+			traces.push_back(entry.path());
+		}
+	}
+	size_t keep = static_cast<size_t>(std::max(maxFiles, 1));
+	if (traces.size() <= keep) {
+		return;
+	}
+	std::sort(traces.begin(), traces.end());
+	for (size_t i = 0; i + keep < traces.size(); ++i) {
+		std::filesystem::remove(traces[i], error);
+	}
+}
@@ -0,0 +1,91 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <filesystem>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+
+// Records timed spans while a run is traced and dumps them as a Chrome trace
+// (chrome://tracing, ui.perfetto.dev), one track per thread. Outside a traced
+// run a span costs one relaxed atomic load.
+class Tracer {
+public:
+	using Clock = std::chrono::steady_clock;
+
+	static Tracer& instance();
+
+	bool isRecording() const { return m_recording.load(std::memory_order_relaxed); }
+	// Drops whatever was recorded and starts a new run
+	void beginRun();
+	// Adds the run itself as a span on the calling thread and writes the trace to
+	// directory/<UTC time>-<name>.json, keeping the newest maxFiles traces
+	bool endRun(const std::string& name, const std::string& detail, const std::filesystem::path& directory, int maxFiles = 20);
+
+	void record(const char* name, const std::string& detail, Clock::time_point start, Clock::time_point end);
+	// Track name of the calling thread, kept for the thread's lifetime
+	static void setThreadName(const std::string& name);
+
+private:
+	struct Event {
+		const char* name = nullptr;
+		std::string detail;
+		Clock::time_point start;
+		Clock::time_point end;
+	};
+
+	// Only contended while a run is written out
+	struct ThreadBuffer {
+		std::mutex mutex;
+		uint32_t thread = 0;
+		std::string name;
+		std::vector<Event> events;
+		std::atomic<bool> closed{ false }; // thread exited
+	};
+
+	Tracer() = default;
+
+	ThreadBuffer& threadBuffer();
+	static void pruneTraces(const std::filesystem::path& directory, int maxFiles);
+
+private:
+	std::atomic<bool> m_recording{ false };
+	std::atomic<uint32_t> m_nextThread{ 1 };
+	Clock::time_point m_runStart;
+
+	std::mutex m_buffersMutex;
+	std::vector<std::shared_ptr<ThreadBuffer>> m_buffers;
+};
+
+// Span from construction to the end of the scope
+class TraceSpan {
+public:
+	explicit TraceSpan(const char* name)
+		: m_name(Tracer::instance().isRecording() ? name : nullptr)
+	{
+		if (m_name) m_start = Tracer::Clock::now();
+	}
+	TraceSpan(const char* name, const std::string& detail)
+		: TraceSpan(name)
+	{
+		if (m_name) m_detail = detail;
+	}
+	~TraceSpan()
+	{
+		if (m_name) Tracer::instance().record(m_name, m_detail, m_start, Tracer::Clock::now());
+	}
+
+	TraceSpan(const TraceSpan&) = delete;
+	TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+	const char* m_name; // null when not recording
+	std::string m_detail;
+	Tracer::Clock::time_point m_start;
+};
+
+#define ARAS_TRACE_CONCAT_(a, b) a##b
+#define ARAS_TRACE_CONCAT(a, b) ARAS_TRACE_CONCAT_(a, b)
+// TRACE_SCOPE("name") or TRACE_SCOPE("name", detail), detail shown in the span's args
+#define TRACE_SCOPE(...) TraceSpan ARAS_TRACE_CONCAT(traceSpan, __LINE__)(__VA_ARGS__)
@@ -0,0 +1,60 @@
+#pragma once
+#include <array>
+
+// Cosine and sine of every whole degree, computed at compile time so wind
+// components are table lookups instead of std::cos/std::sin calls.
+namespace TrigTable {
+
+constexpr double PI = 3.14159265358979323846;
+
+// Taylor series, only called with |x| <= pi/2 where 12 terms are exact to double precision
+constexpr double sinSeries(double x)
+{
+	double term = x;
+	double sum = x;
+	for (int n = 1; n < 12; ++n) {
+		term *= -x * x / ((2.0 * n) * (2.0 * n + 1.0));
+		sum += term;
+	}
+	return sum;
+}
+
+constexpr double sinDegrees(int degrees)
+{
+	degrees %= 360;
+	if (degrees < 0) degrees += 360;
+	// Fold into [-90, 90]
+	if (degrees > 270) degrees -= 360;
+	else if (degrees > 90) degrees = 180 - degrees;
+	return sinSeries(degrees * PI / 180.0);
+}
+
+constexpr std::array<float, 360> makeSinTable()
+{
+	std::array<float, 360> table{};
+	for (int i = 0; i < 360; ++i) table[i] = static_cast<float>(sinDegrees(i));
+	return table;
+}
+
+constexpr std::array<float, 360> makeCosTable()
+{
+	std::array<float, 360> table{};
+	for (int i = 0; i < 360; ++i) table[i] = static_cast<float>(sinDegrees(i + 90));
+	return table;
+}
+
+inline constexpr std::array<float, 360> sinTable = makeSinTable();
+inline constexpr std::array<float, 360> cosTable = makeCosTable();
+
+constexpr int normalize(int degrees)
+{
+	degrees %= 360;
+	return degrees < 0 ? degrees + 360 : degrees;
+}
+
+constexpr float cosDeg(int degrees) { return cosTable[normalize(degrees)]; }
+constexpr float sinDeg(int degrees) { return sinTable[normalize(degrees)]; }
+
+static_assert(cosTable[0] == 1.0f && cosTable[180] == -1.0f && sinTable[90] == 1.0f && sinTable[270] == -1.0f);
+
+} // namespace TrigTable
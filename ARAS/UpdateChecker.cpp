@@ -0,0 +1,143 @@
+#include "UpdateChecker.h"
+#include <nlohmann/json.hpp>
+
+#define CPPHTTPLIB_OPENSSL_SUPPORT
+#include <httplib.h>
+
+#include "AtomicFile.h"
+#include "Logger.h"
+
+constexpr const char* RELEASES_HOST = "https://api.github.com";
+constexpr const char* LATEST_RELEASE_ENDPOINT = "/repos/AlexisBalzano/ARASv2/releases/latest";
+constexpr time_t CONNECTION_TIMEOUT_SECONDS = 3;
+constexpr time_t READ_TIMEOUT_SECONDS = 5;
+
+// GitHub gives asset digests as "sha256:<hex>"
+static std::string sha256FromDigest(const std::string& digest)
+{
+	const std::string prefix = "sha256:";
+	return digest.compare(0, prefix.size(), prefix) == 0 ? digest.substr(prefix.size()) : std::string();
+}
+
+UpdateChecker::UpdateChecker(std::filesystem::path cacheFile, std::string currentVersion)
+	: m_cacheFile(std::move(cacheFile)), m_currentVersion(std::move(currentVersion))
+{
+}
+
+std::optional<ReleaseInfo> UpdateChecker::check()
+{
+	Cache cache;
+	bool cached = loadCache(cache);
+	auto now = std::chrono::system_clock::now();
+	if (cached && now - cache.checkedAt < cooldown) {
+		LOG_INFO << "Update check skipped, last release known: " << cache.release.tag;
+		return newerThanCurrent(cache.release);
+	}
+
+	httplib::Client cli(RELEASES_HOST);
+	cli.set_connection_timeout(CONNECTION_TIMEOUT_SECONDS);
+	cli.set_read_timeout(READ_TIMEOUT_SECONDS);
+	httplib::Headers headers = { {"User-Agent", "ARAS-Updater"} };
+	if (cached && !cache.etag.empty()) {
+		headers.emplace("If-None-Match", cache.etag); // a 304 does not count against the rate limit
+	}
+
+	auto res = cli.Get(LATEST_RELEASE_ENDPOINT, headers);
+	if (!res) {
+		LOG_ERROR << "Update check failed: " << httplib::to_string(res.error());
+		return std::nullopt;
+	}
+	if (res->status == 304 && cached) {
+		cache.checkedAt = now;
+		saveCache(cache);
+		return newerThanCurrent(cache.release);
+	}
+	if (res->status != 200) {
+		LOG_ERROR << "Update check failed with status " << res->status;
+		return std::nullopt;
+	}
+
+	try {
+		auto json = nlohmann::json::parse(res->body);
+		ReleaseInfo release;
+		release.tag = json.value("tag_name", "");
+		if (!json.contains("assets") || json["assets"].empty()) {
+			LOG_WARNING << "No assets found for the latest release.";
+			return std::nullopt;
+		}
+		for (const auto& asset : json["assets"]) {
+			std::string name = asset.value("name", "");
+			if (name == "ARASsetup.exe") {
+				release.setupUrl = asset.value("browser_download_url", "");
+				release.setupSha256 = sha256FromDigest(asset.value("digest", ""));
+			}
+			else if (name == "ARASsetup.msi") {
+				release.msiUrl = asset.value("browser_download_url", "");
+				release.msiSha256 = sha256FromDigest(asset.value("digest", ""));
+			}
+		}
+		cache.checkedAt = now;
+		cache.etag = res->get_header_value("ETag");
+		cache.release = release;
+		saveCache(cache);
+		return newerThanCurrent(release);
+	}
+	catch (const std::exception& e) {
+		LOG_ERROR << "Error parsing new version: " << e.what();
+	}
+	return std::nullopt;
+}
+
+std::optional<ReleaseInfo> UpdateChecker::newerThanCurrent(const ReleaseInfo& release) const
+{
+	if (release.tag.empty() || release.tag == m_currentVersion) {
+		LOG_INFO << "You are using the latest version of ARAS.";
+		return std::nullopt;
+	}
+	LOG_INFO << "A new version of ARAS is available: " << release.tag;
+	return release;
+}
+
+bool UpdateChecker::loadCache(Cache& cache) const
+{
+	std::string content;
+	if (!AtomicFile::read(m_cacheFile, content)) {
+		return false;
+	}
+	nlohmann::json json = nlohmann::json::parse(content, nullptr, false);
+	if (!json.is_object()) {
+		return false;
+	}
+	try {
+		cache.checkedAt = std::chrono::system_clock::time_point(std::chrono::seconds(json.value("checkedAt", int64_t{ 0 })));
+		cache.etag = json.value("etag", "");
+		cache.release.tag = json.value("tag_name", "");
+		cache.release.setupUrl = json.value("setupUrl", "");
+		cache.release.msiUrl = json.value("msiUrl", "");
+		cache.release.setupSha256 = json.value("setupSha256", "");
+		cache.release.msiSha256 = json.value("msiSha256", "");
+	}
+	catch (const std::exception& e) {
+		LOG_ERROR << "Error parsing update cache: " << e.what();
+		return false;
+	}
+	return true;
+}
+
+bool UpdateChecker::saveCache(const Cache& cache) const
+{
+	nlohmann::json json = {
+		{"checkedAt", std::chrono::duration_cast<std::chrono::seconds>(cache.checkedAt.time_since_epoch()).count()},
+		{"etag", cache.etag},
+		{"tag_name", cache.release.tag},
+		{"setupUrl", cache.release.setupUrl},
+		{"msiUrl", cache.release.msiUrl},
+		{"setupSha256", cache.release.setupSha256},
+		{"msiSha256", cache.release.msiSha256}
+	};
+	if (!AtomicFile::write(m_cacheFile, json.dump(4))) {
+		LOG_ERROR << "Failed to write update cache.";
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <string>
+#include <filesystem>
+#include <optional>
+#include <chrono>
+
+// Latest GitHub release of ARAS
+struct ReleaseInfo {
+	std::string tag;
+	std::string setupUrl;
+	std::string msiUrl;
+	// Lowercase hex SHA-256 from the asset "digest", empty when GitHub gave none
+	std::string setupSha256;
+	std::string msiSha256;
+};
+
+// Release check that never holds up startup. Meant to run on a background
+// task: short timeouts, the last release and its ETag are kept in a cache
+// file so GitHub can answer 304, and launches within the cooldown of the last
+// check do not touch the network at all.
+class UpdateChecker {
+public:
+	static constexpr std::chrono::hours cooldown{ 6 };
+
+	UpdateChecker(std::filesystem::path cacheFile, std::string currentVersion);
+
+	// The newer release, nothing when up to date or when no release is known
+	std::optional<ReleaseInfo> check();
+
+private:
+	struct Cache {
+		std::chrono::system_clock::time_point checkedAt{};
+		std::string etag;
+		ReleaseInfo release;
+	};
+
+	bool loadCache(Cache& cache) const;
+	bool saveCache(const Cache& cache) const;
+	std::optional<ReleaseInfo> newerThanCurrent(const ReleaseInfo& release) const;
+
+private:
+	std::filesystem::path m_cacheFile;
+	std::string m_currentVersion;
+};
@@ -0,0 +1,8 @@
+#pragma once
+
+struct WindData {
+	int windDirection;
+	int windSpeed;
+	int windGust;
+	bool stale = false; // last known value used because the station could not be fetched
+};
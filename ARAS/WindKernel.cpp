@@ -0,0 +1,367 @@
+#include "WindKernel.h"
+#include <algorithm>
+#include <cmath>
+
+#include "TrigTable.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define ARAS_KERNEL_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// MSVC accepts any intrinsic, gcc and clang need the ISA enabled per function
+#if defined(ARAS_KERNEL_X86) && !defined(_MSC_VER)
+#define ARAS_TARGET(isa) __attribute__((target(isa)))
+#else
+#define ARAS_TARGET(isa)
+#endif
+
+WindKernelTable WindKernel::buildTable(const RunwayIndex& index, std::span<const AirportRunways* const> airports)
+{
+	WindKernelTable table;
+	table.airportCount = airports.size();
+	for (const AirportRunways* airport : airports) {
+		if (airport == nullptr) continue;
+		table.slotCount = std::max(table.slotCount, airport->configCount);
+		for (const RunwayConfig& config : index.getConfigs(*airport)) {
+			table.headingSlots = std::max<uint32_t>(table.headingSlots, config.headingCount);
+		}
+	}
+	// Airports without configurations still get one invalid slot so every path has something to compare against
+	table.slotCount = std::max(table.slotCount, 1u);
+	table.headingSlots = std::max(table.headingSlots, 1u);
+
+	const size_t n = table.airportCount;
+	table.headings.assign(static_cast<size_t>(table.slotCount) * table.headingSlots * n, 0);
+	table.limits.assign(static_cast<size_t>(table.slotCount) * n, 0.f);
+	table.valid.assign(static_cast<size_t>(table.slotCount) * n, 0);
+
+	for (size_t i = 0; i < n; ++i) {
+		if (airports[i] == nullptr) continue;
+		std::span<const RunwayConfig> configs = index.getConfigs(*airports[i]);
+		for (uint32_t slot = 0; slot < configs.size(); ++slot) {
+			const RunwayConfig& config = configs[slot];
+			for (uint32_t h = 0; h < table.headingSlots; ++h) {
+				int heading = config.headings[h < config.headingCount ? h : 0];
+				table.headings[(static_cast<size_t>(slot) * table.headingSlots + h) * n + i] = TrigTable::normalize(heading);
+			}
+			table.limits[slot * n + i] = static_cast<float>(config.preferential);
+			table.valid[slot * n + i] = -1;
+		}
+	}
+	return table;
+}
+
+void WindKernel::selectConfigs(const WindKernelTable& table, std::span<const int32_t> windDirection,
+	std::span<const float> windSpeed, std::span<const float> windGust, std::span<int32_t> configIndex)
+{
+	selectConfigs(table, windDirection, windSpeed, windGust, configIndex, bestIsa());
+}
+
+void WindKernel::selectConfigs(const WindKernelTable& table, std::span<const int32_t> windDirection,
+	std::span<const float> windSpeed, std::span<const float> windGust, std::span<int32_t> configIndex, Isa isa)
+{
+	size_t count = std::min({ table.airportCount, windDirection.size(), windSpeed.size(), windGust.size(), configIndex.size() });
+	if (static_cast<int>(isa) > static_cast<int>(bestIsa())) {
+		isa = bestIsa();
+	}
+
+	size_t done = 0;
+	if (isa == Isa::Avx2) {
+		done = selectAvx2(table, count, windDirection.data(), windSpeed.data(), windGust.data(), configIndex.data());
+	}
+	else if (isa == Isa::Sse2) {
+		done = selectSse2(table, count, windDirection.data(), windSpeed.data(), windGust.data(), configIndex.data());
+	}
+	// Remainder that does not fill a vector
+	selectScalar(table, done, count, windDirection.data(), windSpeed.data(), windGust.data(), configIndex.data());
+}
+
+void WindKernel::selectScalar(const WindKernelTable& table, size_t begin, size_t end, const int32_t* direction,
+	const float* speed, const float* gust, int32_t* configIndex)
+{
+	const size_t n = table.airportCount;
+	for (size_t i = begin; i < end; ++i) {
+		const bool vrb = direction[i] == 0;
+		const float s = std::max(speed[i], 0.f);
+		const float g = std::max(s, gust[i]);
+
+		int32_t chosen = -1;
+		int32_t bestIndex = 0;
+		float bestGustTailwind = 0.f, bestHeadwind = 0.f, bestCrosswind = 0.f;
+		for (uint32_t slot = 0; slot < table.slotCount; ++slot) {
+			float headwind = 0.f, crosswind = 0.f, gustTailwind = 0.f;
+			for (uint32_t h = 0; h < table.headingSlots; ++h) {
+				int32_t angle = direction[i] - table.headings[(static_cast<size_t>(slot) * table.headingSlots + h) * n + i];
+				if (angle < 0) angle += 360;
+				if (angle >= 360) angle -= 360;
+				float along = vrb ? -1.f : TrigTable::cosTable[angle];
+				float across = vrb ? 1.f : std::abs(TrigTable::sinTable[angle]);
+
+				float runwayHeadwind = s * along;
+				float runwayCrosswind = s * across;
+				float runwayGustTailwind = std::max(-g * along, 0.f);
+				headwind = h == 0 ? runwayHeadwind : std::min(headwind, runwayHeadwind);
+				crosswind = h == 0 ? runwayCrosswind : std::max(crosswind, runwayCrosswind);
+				gustTailwind = h == 0 ? runwayGustTailwind : std::max(gustTailwind, runwayGustTailwind);
+			}
+
+			const bool valid = table.valid[slot * n + i] != 0;
+			if (valid && chosen < 0 && gustTailwind <= table.limits[slot * n + i]) {
+				chosen = static_cast<int32_t>(slot);
+			}
+			bool better = slot == 0 || (valid && (gustTailwind < bestGustTailwind
+				|| (gustTailwind == bestGustTailwind && headwind > bestHeadwind)
+				|| (gustTailwind == bestGustTailwind && headwind == bestHeadwind && crosswind < bestCrosswind)));
+			if (better) {
+				bestIndex = static_cast<int32_t>(slot);
+				bestGustTailwind = gustTailwind;
+				bestHeadwind = headwind;
+				bestCrosswind = crosswind;
+			}
+		}
+		configIndex[i] = chosen >= 0 ? chosen : bestIndex;
+	}
+}
+
+#ifdef ARAS_KERNEL_X86
+
+ARAS_TARGET("sse2") static inline __m128 blend128(__m128 mask, __m128 a, __m128 b)
+{
+	return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+ARAS_TARGET("sse2") static inline __m128i blend128i(__m128i mask, __m128i a, __m128i b)
+{
+	return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+ARAS_TARGET("sse2")
+size_t WindKernel::selectSse2(const WindKernelTable& table, size_t count, const int32_t* direction,
+	const float* speed, const float* gust, int32_t* configIndex)
+{
+	const size_t n = table.airportCount;
+	const __m128i zeroInt = _mm_setzero_si128();
+	const __m128i fullTurn = _mm_set1_epi32(360);
+	const __m128i lastDegree = _mm_set1_epi32(359);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.f);
+	const __m128 minusOne = _mm_set1_ps(-1.f);
+	const __m128 signBit = _mm_set1_ps(-0.f);
+	const __m128 allSet = _mm_castsi128_ps(_mm_set1_epi32(-1));
+	const float* cosTable = TrigTable::cosTable.data();
+	const float* sinTable = TrigTable::sinTable.data();
+	alignas(16) int32_t angles[4];
+
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4) {
+		const __m128i dir = _mm_loadu_si128(reinterpret_cast<const __m128i*>(direction + i));
+		const __m128 s = _mm_max_ps(_mm_loadu_ps(speed + i), zero);
+		const __m128 g = _mm_max_ps(s, _mm_loadu_ps(gust + i));
+		const __m128 negativeGust = _mm_xor_ps(g, signBit);
+		const __m128 vrb = _mm_castsi128_ps(_mm_cmpeq_epi32(dir, zeroInt));
+
+		__m128i chosen = zeroInt;
+		__m128 found = zero;
+		__m128i bestIndex = zeroInt;
+		__m128 bestGustTailwind = zero, bestHeadwind = zero, bestCrosswind = zero;
+
+		for (uint32_t slot = 0; slot < table.slotCount; ++slot) {
+			__m128 headwind = zero, crosswind = zero, gustTailwind = zero;
+			for (uint32_t h = 0; h < table.headingSlots; ++h) {
+				const int32_t* headings = table.headings.data() + (static_cast<size_t>(slot) * table.headingSlots + h) * n + i;
+				__m128i angle = _mm_sub_epi32(dir, _mm_loadu_si128(reinterpret_cast<const __m128i*>(headings)));
+				angle = _mm_add_epi32(angle, _mm_and_si128(_mm_cmplt_epi32(angle, zeroInt), fullTurn));
+				angle = _mm_sub_epi32(angle, _mm_and_si128(_mm_cmpgt_epi32(angle, lastDegree), fullTurn));
+
+				// No gather before AVX2
+				_mm_store_si128(reinterpret_cast<__m128i*>(angles), angle);
+				__m128 cosine = _mm_setr_ps(cosTable[angles[0]], cosTable[angles[1]], cosTable[angles[2]], cosTable[angles[3]]);
+				__m128 sine = _mm_setr_ps(sinTable[angles[0]], sinTable[angles[1]], sinTable[angles[2]], sinTable[angles[3]]);
+
+				__m128 along = blend128(vrb, minusOne, cosine);
+				__m128 across = blend128(vrb, one, _mm_andnot_ps(signBit, sine));
+				__m128 runwayHeadwind = _mm_mul_ps(s, along);
+				__m128 runwayCrosswind = _mm_mul_ps(s, across);
+				__m128 runwayGustTailwind = _mm_max_ps(_mm_mul_ps(negativeGust, along), zero);
+				if (h == 0) {
+					headwind = runwayHeadwind;
+					crosswind = runwayCrosswind;
+					gustTailwind = runwayGustTailwind;
+				}
+				else {
+					headwind = _mm_min_ps(headwind, runwayHeadwind);
+					crosswind = _mm_max_ps(crosswind, runwayCrosswind);
+					gustTailwind = _mm_max_ps(gustTailwind, runwayGustTailwind);
+				}
+			}
+
+			const __m128 valid = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(table.valid.data() + slot * n + i)));
+			const __m128 limit = _mm_loadu_ps(table.limits.data() + slot * n + i);
+			const __m128i slotIndex = _mm_set1_epi32(static_cast<int32_t>(slot));
+
+			__m128 qualified = _mm_andnot_ps(found, _mm_and_ps(valid, _mm_cmple_ps(gustTailwind, limit)));
+			chosen = blend128i(_mm_castps_si128(qualified), slotIndex, chosen);
+			found = _mm_or_ps(found, qualified);
+
+			__m128 sameGust = _mm_cmpeq_ps(gustTailwind, bestGustTailwind);
+			__m128 better = _mm_or_ps(_mm_cmplt_ps(gustTailwind, bestGustTailwind),
+				_mm_and_ps(sameGust, _mm_or_ps(_mm_cmpgt_ps(headwind, bestHeadwind),
+					_mm_and_ps(_mm_cmpeq_ps(headwind, bestHeadwind), _mm_cmplt_ps(crosswind, bestCrosswind)))));
+			better = slot == 0 ? allSet : _mm_and_ps(valid, better);
+			bestIndex = blend128i(_mm_castps_si128(better), slotIndex, bestIndex);
+			bestGustTailwind = blend128(better, gustTailwind, bestGustTailwind);
+			bestHeadwind = blend128(better, headwind, bestHeadwind);
+			bestCrosswind = blend128(better, crosswind, bestCrosswind);
+		}
+
+		__m128i result = blend128i(_mm_castps_si128(found), chosen, bestIndex);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(configIndex + i), result);
+	}
+	return i;
+}
+
+ARAS_TARGET("avx2")
+size_t WindKernel::selectAvx2(const WindKernelTable& table, size_t count, const int32_t* direction,
+	const float* speed, const float* gust, int32_t* configIndex)
+{
+	const size_t n = table.airportCount;
+	const __m256i zeroInt = _mm256_setzero_si256();
+	const __m256i fullTurn = _mm256_set1_epi32(360);
+	const __m256i lastDegree = _mm256_set1_epi32(359);
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 one = _mm256_set1_ps(1.f);
+	const __m256 minusOne = _mm256_set1_ps(-1.f);
+	const __m256 signBit = _mm256_set1_ps(-0.f);
+	const __m256 allSet = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+	const float* cosTable = TrigTable::cosTable.data();
+	const float* sinTable = TrigTable::sinTable.data();
+
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		const __m256i dir = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(direction + i));
+		const __m256 s = _mm256_max_ps(_mm256_loadu_ps(speed + i), zero);
+		const __m256 g = _mm256_max_ps(s, _mm256_loadu_ps(gust + i));
+		const __m256 negativeGust = _mm256_xor_ps(g, signBit);
+		const __m256 vrb = _mm256_castsi256_ps(_mm256_cmpeq_epi32(dir, zeroInt));
+
+		__m256i chosen = zeroInt;
+		__m256 found = zero;
+		__m256i bestIndex = zeroInt;
+		__m256 bestGustTailwind = zero, bestHeadwind = zero, bestCrosswind = zero;
+
+		for (uint32_t slot = 0; slot < table.slotCount; ++slot) {
+			__m256 headwind = zero, crosswind = zero, gustTailwind = zero;
+			for (uint32_t h = 0; h < table.headingSlots; ++h) {
+				const int32_t* headings = table.headings.data() + (static_cast<size_t>(slot) * table.headingSlots + h) * n + i;
+				__m256i angle = _mm256_sub_epi32(dir, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(headings)));
+				angle = _mm256_add_epi32(angle, _mm256_and_si256(_mm256_cmpgt_epi32(zeroInt, angle), fullTurn));
+				angle = _mm256_sub_epi32(angle, _mm256_and_si256(_mm256_cmpgt_epi32(angle, lastDegree), fullTurn));
+
+				__m256 cosine = _mm256_i32gather_ps(cosTable, angle, 4);
+				__m256 sine = _mm256_i32gather_ps(sinTable, angle, 4);
+
+				__m256 along = _mm256_blendv_ps(cosine, minusOne, vrb);
+				__m256 across = _mm256_blendv_ps(_mm256_andnot_ps(signBit, sine), one, vrb);
+				__m256 runwayHeadwind = _mm256_mul_ps(s, along);
+				__m256 runwayCrosswind = _mm256_mul_ps(s, across);
+				__m256 runwayGustTailwind = _mm256_max_ps(_mm256_mul_ps(negativeGust, along), zero);
+				if (h == 0) {
+					headwind = runwayHeadwind;
+					crosswind = runwayCrosswind;
+					gustTailwind = runwayGustTailwind;
+				}
+				else {
+					headwind = _mm256_min_ps(headwind, runwayHeadwind);
+					crosswind = _mm256_max_ps(crosswind, runwayCrosswind);
+					gustTailwind = _mm256_max_ps(gustTailwind, runwayGustTailwind);
+				}
+			}
+
+			const __m256 valid = _mm256_castsi256_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(table.valid.data() + slot * n + i)));
+			const __m256 limit = _mm256_loadu_ps(table.limits.data() + slot * n + i);
+			const __m256 slotIndex = _mm256_castsi256_ps(_mm256_set1_epi32(static_cast<int32_t>(slot)));
+
+			__m256 qualified = _mm256_andnot_ps(found, _mm256_and_ps(valid, _mm256_cmp_ps(gustTailwind, limit, _CMP_LE_OQ)));
+			chosen = _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(chosen), slotIndex, qualified));
+			found = _mm256_or_ps(found, qualified);
+
+			__m256 sameGust = _mm256_cmp_ps(gustTailwind, bestGustTailwind, _CMP_EQ_OQ);
+			__m256 better = _mm256_or_ps(_mm256_cmp_ps(gustTailwind, bestGustTailwind, _CMP_LT_OQ),
+				_mm256_and_ps(sameGust, _mm256_or_ps(_mm256_cmp_ps(headwind, bestHeadwind, _CMP_GT_OQ),
+					_mm256_and_ps(_mm256_cmp_ps(headwind, bestHeadwind, _CMP_EQ_OQ), _mm256_cmp_ps(crosswind, bestCrosswind, _CMP_LT_OQ)))));
+			better = slot == 0 ? allSet : _mm256_and_ps(valid, better);
+			bestIndex = _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(bestIndex), slotIndex, better));
+			bestGustTailwind = _mm256_blendv_ps(bestGustTailwind, gustTailwind, better);
+			bestHeadwind = _mm256_blendv_ps(bestHeadwind, headwind, better);
+			bestCrosswind = _mm256_blendv_ps(bestCrosswind, crosswind, better);
+		}
+
+		__m256 result = _mm256_blendv_ps(_mm256_castsi256_ps(bestIndex), _mm256_castsi256_ps(chosen), found);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(configIndex + i), _mm256_castps_si256(result));
+	}
+	return i;
+}
+
+WindKernel::Isa WindKernel::detectIsa()
+{
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	int maxLeaf = info[0];
+	__cpuid(info, 1);
+	bool sse2 = (info[3] & (1 << 26)) != 0;
+	bool osxsave = (info[2] & (1 << 27)) != 0;
+	bool avx = (info[2] & (1 << 28)) != 0;
+	bool avx2 = false;
+	// The OS must also save the ymm registers on context switches
+	if (maxLeaf >= 7 && osxsave && avx && (_xgetbv(0) & 0x6) == 0x6) {
+		__cpuidex(info, 7, 0);
+		avx2 = (info[1] & (1 << 5)) != 0;
+	}
+#else
+	__builtin_cpu_init();
+	bool sse2 = __builtin_cpu_supports("sse2");
+	bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+	if (avx2) return Isa::Avx2;
+	if (sse2) return Isa::Sse2;
+	return Isa::Scalar;
+}
+
+#else
+
+size_t WindKernel::selectSse2(const WindKernelTable&, size_t, const int32_t*, const float*, const float*, int32_t*)
+{
+	return 0;
+}
+
+size_t WindKernel::selectAvx2(const WindKernelTable&, size_t, const int32_t*, const float*, const float*, int32_t*)
+{
+	return 0;
+}
+
+WindKernel::Isa WindKernel::detectIsa()
+{
+	return Isa::Scalar;
+}
+
+#endif
+
+WindKernel::Isa WindKernel::bestIsa()
+{
+	static const Isa isa = detectIsa();
+	return isa;
+}
+
+const char* WindKernel::isaName(Isa isa)
+{
+	switch (isa) {
+	case Isa::Avx2: return "AVX2";
+	case Isa::Sse2: return "SSE2";
+	default: return "scalar";
+	}
+}
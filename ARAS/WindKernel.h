@@ -0,0 +1,48 @@
+#pragma once
+#include <vector>
+#include <span>
+#include <cstdint>
+
+#include "RunwayIndex.h"
+
+// Runway configurations of a list of airports stored column by column: the
+// value for configuration slot s of airport i is at [s * airportCount + i].
+// Airports with fewer configurations or runways are padded, padding slots are
+// marked invalid and padding runways repeat the configuration's first heading.
+struct WindKernelTable {
+	size_t airportCount = 0;
+	uint32_t slotCount = 0; // configurations of the largest airport
+	uint32_t headingSlots = 0; // runways per configuration, largest one
+	std::vector<int32_t> headings; // [slot][heading][airport], degrees in [0, 360)
+	std::vector<float> limits; // [slot][airport], "preferential" tailwind in kt
+	std::vector<int32_t> valid; // [slot][airport], -1 when the airport has that configuration, 0 otherwise
+};
+
+// Branchless version of RunwaySelector::select over a whole table, with SSE2
+// and AVX2 paths picked at runtime. Every path uses the same trig tables and
+// float operations as the selector so they all return the same configuration.
+class WindKernel {
+public:
+	enum class Isa { Scalar, Sse2, Avx2 };
+
+	static WindKernelTable buildTable(const RunwayIndex& index, std::span<const AirportRunways* const> airports);
+
+	// Directions are in [0, 360] with 0 meaning VRB, as in WindData. Writes
+	// the chosen configuration slot of every airport to configIndex.
+	static void selectConfigs(const WindKernelTable& table, std::span<const int32_t> windDirection,
+		std::span<const float> windSpeed, std::span<const float> windGust, std::span<int32_t> configIndex);
+	static void selectConfigs(const WindKernelTable& table, std::span<const int32_t> windDirection,
+		std::span<const float> windSpeed, std::span<const float> windGust, std::span<int32_t> configIndex, Isa isa);
+
+	static Isa detectIsa();
+	static Isa bestIsa(); // detectIsa() cached
+	static const char* isaName(Isa isa);
+
+private:
+	static void selectScalar(const WindKernelTable& table, size_t begin, size_t end, const int32_t* direction,
+		const float* speed, const float* gust, int32_t* configIndex);
+	static size_t selectSse2(const WindKernelTable& table, size_t count, const int32_t* direction,
+		const float* speed, const float* gust, int32_t* configIndex);
+	static size_t selectAvx2(const WindKernelTable& table, size_t count, const int32_t* direction,
+		const float* speed, const float* gust, int32_t* configIndex);
+};
@@ -0,0 +1,52 @@
+#include "WorkerPool.h"
+
+#include "Tracer.h"
+
+WorkerPool::WorkerPool(size_t threadCount, const std::string& name)
+{
+	if (threadCount == 0) threadCount = 1;
+	m_workers.reserve(threadCount);
+	for (size_t i = 0; i < threadCount; ++i) {
+		std::string threadName = name.empty() ? std::string() : name + " " + std::to_string(i + 1);
+		m_workers.emplace_back(&WorkerPool::workerLoop, this, std::move(threadName));
+	}
+}
+
+WorkerPool::~WorkerPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_taskAvailable.notify_all();
+	for (auto& worker : m_workers) {
+		if (worker.joinable())
+			worker.join();
+	}
+}
+
+size_t WorkerPool::pendingTasks() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_tasks.size();
+}
+
+void WorkerPool::workerLoop(std::string threadName)
+{
+	if (!threadName.empty()) {
+		Tracer::setThreadName(threadName);
+	}
+	while (true) {
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_taskAvailable.wait(lock, [this] { return m_stop || !m_tasks.empty(); });
+			if (m_tasks.empty()) {
+				return; // stopping and nothing left to run
+			}
+			task = std::move(m_tasks.front());
+			m_tasks.pop_front();
+		}
+		task();
+	}
+}
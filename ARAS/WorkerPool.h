@@ -0,0 +1,54 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <type_traits>
+#include <string>
+
+// Fixed number of worker threads consuming a FIFO task queue.
+// Queued tasks are still run when the pool is destroyed.
+class WorkerPool {
+public:
+	// Named pools get one trace track per worker, "name 1", "name 2"...
+	explicit WorkerPool(size_t threadCount, const std::string& name = {});
+	~WorkerPool();
+
+	WorkerPool(const WorkerPool&) = delete;
+	WorkerPool& operator=(const WorkerPool&) = delete;
+
+	template <typename F>
+	std::future<std::invoke_result_t<std::decay_t<F>>> submit(F&& task);
+
+	size_t size() const { return m_workers.size(); }
+	size_t pendingTasks() const;
+
+private:
+	void workerLoop(std::string threadName);
+
+private:
+	std::vector<std::thread> m_workers;
+	std::deque<std::function<void()>> m_tasks;
+	mutable std::mutex m_mutex;
+	std::condition_variable m_taskAvailable;
+	bool m_stop = false;
+};
+
+template <typename F>
+std::future<std::invoke_result_t<std::decay_t<F>>> WorkerPool::submit(F&& task)
+{
+	using Result = std::invoke_result_t<std::decay_t<F>>;
+	// std::function needs a copyable target, hence the shared_ptr around the packaged_task
+	auto packagedTask = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+	std::future<Result> future = packagedTask->get_future();
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_tasks.emplace_back([packagedTask]() { (*packagedTask)(); });
+	}
+	m_taskAvailable.notify_one();
+	return future;
+}
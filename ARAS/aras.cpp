@@ -4,12 +4,19 @@
 #include <WinSock2.h>
 #include <windows.h>
 #include <shellapi.h>
-#include <iostream>
 #include <fstream>
 #include <filesystem>
 #include <cstdio>
+#include <chrono>
 
 #include "Aras.h"
+#include "FileDownload.h"
+#include "Logger.h"
+#include "Metrics.h"
+
+// Longest sleep of an idle GUI, TGUI timers such as the edit cursor blink are checked at this rate
+constexpr std::chrono::milliseconds IDLE_WAIT{ 100 };
+constexpr std::chrono::milliseconds DOWNLOAD_PROGRESS_INTERVAL{ 50 };
 
 Aras::Aras()
 {
@@ -28,48 +35,35 @@ void Aras::initialise()
 	//m_renderThread = std::thread(&Aras::run, this);
 
 	m_dataManager = std::make_unique<DataManager>();
+	m_runwayAssigner = std::make_unique<RunwayAssigner>(*m_dataManager);
+	m_runwayAssigner->setProvisionalOutput(m_dataManager->hasWindSnapshot());
 	m_soundPlayer = std::make_unique<SoundPlayer>();
+	m_assignmentWorker = std::make_unique<WorkerPool>(1, "Assignment");
+	if (int metricsPort = m_dataManager->getMetricsPort()) {
+		m_metricsServer.start(metricsPort);
+	}
 
 	createMainWindow();
 
-	m_newVersion = newVersionAvailable(m_setupUrl, m_msiUrl);
-	if (m_newVersion) {
-		// Create pop-up to ask if the user wants to install the new version
-		MSGBOXPARAMSA msgboxParams = { sizeof(msgboxParams) };
-		msgboxParams.hwndOwner = NULL;
-		msgboxParams.hInstance = NULL;
-		msgboxParams.lpszText = "A new version of ARAS is available. Do you want to install it now?";
-		msgboxParams.lpszCaption = "ARAS Updater";
-		msgboxParams.dwStyle = MB_ICONQUESTION | MB_YESNO | MB_DEFBUTTON2;
-		msgboxParams.dwContextHelpId = 0;
-		int msgboxResult = MessageBoxIndirectA(&msgboxParams);
-		if (msgboxResult == IDYES) {
-			std::cerr << "User chose to install the new version now." << std::endl;
-			m_loadingWindow = std::make_unique<GuiLoadingWindow>(500, 220, "Updater", this);
-			if (m_loadingWindow->createWindow()) {
-				if (m_loadingWindow->isOpen()) {
-					m_loadingWindow->render();
-				}
-			}
-			else {
-				std::cerr << "Failed to create Loading window." << std::endl;
-			}
-			downloadFiles(m_setupUrl, m_msiUrl);
-			std::cerr << "Installer files downloaded." << std::endl;
-			launchInstaller();
+	// Installer files left by a previous update, partial downloads are kept to be resumed
+	if (std::filesystem::exists("ARASsetup.exe")) {
+		if (std::remove("ARASsetup.exe") != 0) {
+			LOG_ERROR << "Error deleting file";
 		}
-		std::cerr << "User chose not to install the new version now." << std::endl;
 	}
-	else {
-		// remove any existing installer files
-		if (std::filesystem::exists("ARASsetup.exe")) {
-			if (std::remove("ARASsetup.exe") != 0) std::cerr << "Error deleting file" << std::endl;
-		}
-		if (std::filesystem::exists("ARASsetup.msi")) {
-			if (std::remove("ARASsetup.msi") != 0) std::cerr << "Error deleting file" << std::endl;
+	if (std::filesystem::exists("ARASsetup.msi")) {
+		if (std::remove("ARASsetup.msi") != 0) {
+			LOG_ERROR << "Error deleting file";
 		}
 	}
 
+	// The main window shows up right away, the prompt comes when the answer does
+	m_updateCheck = std::async(std::launch::async, [this, checker = UpdateChecker(m_dataManager->getConfigPath() / "updatecheck.json", ARAS_VERSION)]() mutable {
+		std::optional<ReleaseInfo> release = checker.check();
+		m_loopWaker.wake();
+		return release;
+	});
+
 	run();
 	
 	shutdown();
@@ -83,12 +77,18 @@ void Aras::run()
 
 		if (m_windows.empty()) return;
 
+		auto frameStart = std::chrono::steady_clock::now();
+		processAssignmentEvents();
+		processUpdateCheck();
+
+		bool drawn = false;
 		for (auto& window : m_windows) {
 			while (const std::optional<sf::Event> event = window->pollWindowEvent()) {
 				window->processEvents(*event);
 			}
-			if (window->isOpen()) {
-				window->render();
+			if (window->isOpen() && window->needsRedraw()) {
+				window->render(); // throttled by the framerate limit
+				drawn = true;
 			}
 		}
 
@@ -100,14 +100,26 @@ void Aras::run()
 
 		for (auto& win : newWindows) {
 			m_windows.push_back(std::move(win));
+			drawn = true;
 		}
 		newWindows.clear();
+
+		// Nothing changed on screen: sleep until input, an assignment event or a TGUI timer
+		if (!drawn) {
+			m_loopWaker.wait(IDLE_WAIT);
+		}
+		else {
+			Metrics::instance().frameSeconds.observe(std::chrono::duration<double>(std::chrono::steady_clock::now() - frameStart).count());
+		}
 	}
 }
 
 void Aras::shutdown()
 {
 	m_stop = true;
+	m_refreshScheduler.stop();
+	m_metricsServer.stop();
+	m_assignmentWorker.reset(); // wait for a running assignment before the data goes away
 	//if (m_renderThread.joinable())
 		//m_renderThread.join();
 }
@@ -118,7 +130,7 @@ void Aras::createMainWindow()
 	if (mainWindow->createWindow()) {
 		m_windows.push_back(std::move(mainWindow));
 	} else {
-		std::cerr << "Failed to create main window." << std::endl;
+		LOG_ERROR << "Failed to create main window.";
 	}
 }
 
@@ -137,128 +149,97 @@ std::vector<std::string> Aras::getDefaultAirports(const std::string& fir) const
 	return m_dataManager->getDefaultAirportsList(fir);
 }
 
-bool Aras::newVersionAvailable(std::string& setupUrl, std::string& msiUrl)
+void Aras::assignRunways(const std::string& fir)
 {
-	httplib::Client cli("https://api.github.com");
-	httplib::Headers headers = { {"User-Agent", "ARAS-Updater"} };
-	std::string apiEndpoint = "/repos/AlexisBalzano/ARASv2/releases/latest";
-
-	auto res = cli.Get(apiEndpoint.c_str(), headers);
-	if (res && res->status == 200) {
-		auto json = nlohmann::json::parse(res->body);
-		std::string latestVersion = json["tag_name"];
-		if (json["assets"].empty()) {
-			std::cerr << "No assets found for the latest release." << std::endl;
-			return false;
-		}
-		if (latestVersion != ARAS_VERSION) {
-			std::cerr << "A new version of ARAS is available: " << latestVersion << std::endl;
-
-			for (auto& asset : json["assets"]) {
-				std::string name = asset["name"];
-				if (name == "ARASsetup.exe") {
-					setupUrl = asset["browser_download_url"];
-				}
-				else if (name == "ARASsetup.msi") {
-					msiUrl = asset["browser_download_url"];
-				}
-			}
-
-			return true;
-		}
-		else {
-			std::cerr << "You are using the latest version of ARAS." << std::endl;
-			return false;
-		}
-	}
-	else {
-		std::cerr << "Error parsing new version: " << res.error() << std::endl;
-		return false;
+	if (m_assigning) {
+		LOG_INFO << "Runway assignment already running.";
+		return;
 	}
+	m_assigning = true;
+	m_assignmentWorker->submit([this, fir]() {
+		m_runwayAssigner->assign({ fir }, [this](AssignmentEvent&& event) {
+			postAssignmentEvent(std::move(event));
+		});
+	});
 }
 
-bool Aras::downloadInstaller(std::ofstream& out, const std::string& url)
+void Aras::setAutoRefresh(bool enabled, const std::string& fir)
 {
-	if (!out) {
-		std::cerr << "Failed to open file for writing" << std::endl;
-		return false;
-	}
-
-	if (url.empty()) {
-		std::cerr << "No URL provided for download" << std::endl;
-		return false;
+	if (!enabled || fir.empty()) {
+		m_refreshScheduler.stop();
+		LOG_INFO << "Auto refresh disabled.";
+		return;
 	}
-
-	httplib::Client cli("https://github.com");
-	cli.set_follow_location(true);
-	httplib::Headers headers = { {"User-Agent", "ARAS-Updater"} };
-
-	auto res = cli.Get(url.substr(std::string("https://github.com").size()).c_str(),
-		headers,
-		[&](const char* data, size_t data_length) {
-			out.write(data, data_length);
-			return true;  // keep receiving
-		},
-		[&](uint64_t current, uint64_t total) {
-			if (total > 0) {
-				int percent = static_cast<int>((current * 100) / total);
-				m_loadingWindow->setProgress(static_cast<float>(percent));
-				m_loadingWindow->render();
-				std::cout << "\rDownloading... " << percent << "% ("
-					<< current / 1024 << " KB / "
-					<< total / 1024 << " KB)" << std::flush;
-				std::this_thread::sleep_for(std::chrono::milliseconds(50));
-			}
-			else {
-				std::cout << "\rDownloading... " << current / 1024 << " KB" << std::flush;
-			}
-			return true; // continue download
+	m_refreshScheduler.start(m_dataManager->getAutoRefreshInterval(), m_dataManager->getAutoRefreshOffset(), [this, fir]() {
+		m_assignmentWorker->submit([this, fir]() {
+			m_runwayAssigner->refresh({ fir }, [this](AssignmentEvent&& event) {
+				postAssignmentEvent(std::move(event));
+			});
 		});
+	});
+	LOG_INFO << "Auto refresh enabled for " << fir << ".";
+}
 
-	if (res && res->status == 200) {
-		std::cout << "Download complete!" << std::endl;
-		return true;
-	}
-	else {
-		std::cerr << "Download failed: " << (res ? std::to_string(res->status) : httplib::to_string(res.error())) << std::endl;
-		return false;
-	}
+void Aras::processAssignmentEvents()
+{
+	m_assignmentEvents.drain([this](AssignmentEvent&& event) {
+		if (event.type == AssignmentEvent::Type::Started) {
+			m_assigning = true; // also covers the scheduled refreshes
+		}
+		if (event.type == AssignmentEvent::Type::Finished) {
+			m_assigning = false;
+			if (event.success && event.rwyChanged) {
+				m_soundPlayer->playSound(SoundPlayer::completionSound);
+			}
+		}
+		for (auto& window : m_windows) {
+			window->onAssignmentEvent(event);
+			window->invalidate();
+		}
+	});
 }
 
-void Aras::assignRunways(const std::string& fir)
+void Aras::processUpdateCheck()
 {
-	std::chrono::system_clock::time_point start = std::chrono::system_clock::now();
-	
-	std::vector<std::string> airports = m_dataManager->getAirportsList(fir);
-	if (airports.empty()) {
-		std::cout << "No airports found for FIR: " << fir << std::endl;
+	if (!m_updateCheck.valid() || m_updateCheck.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
 		return;
 	}
+	std::optional<ReleaseInfo> release = m_updateCheck.get();
+	if (!release) {
+		return;
+	}
+	m_release = *release;
+	for (auto& window : m_windows) {
+		window->onUpdateAvailable(m_release.tag);
+		window->invalidate();
+	}
+}
 
-	std::vector<std::string> runwayText;
-	std::vector<std::future<WindData>> windDataFutureList = m_dataManager->getWindData(airports);
-	
-	for (size_t i = 0; i < airports.size(); ++i) {
-		std::cout << "Processing airport: " << airports[i] << std::endl;
-		WindData windData = windDataFutureList[i].get(); // Wait for wind data to be ready
-		if (windData.windDirection == -1 || windData.windSpeed == -1) {
-			std::cout << "Invalid wind data for airport: " << airports[i] << std::endl;
-			continue;
+void Aras::installUpdate()
+{
+	LOG_INFO << "User chose to install the new version now.";
+	m_loadingWindow = std::make_unique<GuiLoadingWindow>(500, 220, "Updater", this);
+	if (m_loadingWindow->createWindow()) {
+		if (m_loadingWindow->isOpen()) {
+			m_loadingWindow->render();
 		}
-
-		std::vector<std::string> activeAirportStrings = formatActiveAirport(airports[i]);
-		runwayText.insert(runwayText.end(), activeAirportStrings.begin(), activeAirportStrings.end());
-
-		std::vector<std::string> assignedRunwayStrings = formatRunwayOutput(assignAirportRunway(airports[i], windData));
-		runwayText.insert(runwayText.end(), assignedRunwayStrings.begin(), assignedRunwayStrings.end());
 	}
+	else {
+		LOG_ERROR << "Failed to create Loading window.";
+	}
+	if (!downloadFiles(m_release)) {
+		LOG_ERROR << "Installer download failed, the next attempt resumes it.";
+		m_loadingWindow.reset();
+		return;
+	}
+	LOG_INFO << "Installer files downloaded.";
+	launchInstaller();
+}
 
-	m_dataManager->outputRunways(runwayText);
-
-	m_soundPlayer->playSound(SoundPlayer::completionSound);
-	std::chrono::system_clock::time_point end = std::chrono::system_clock::now();
-	std::chrono::duration<double> elapsed_seconds = end - start;
-	std::cout << "Runway assignment completed in " << elapsed_seconds.count() << " seconds." << std::endl;
+void Aras::postAssignmentEvent(AssignmentEvent&& event)
+{
+	m_assignmentEvents.push(std::move(event));
+	m_loopWaker.wake();
 }
 
 void Aras::openSettings()
@@ -275,13 +256,13 @@ void Aras::openSettings()
 		newWindows.push_back(std::move(settingWindow));
 	}
 	else {
-		std::cerr << "Failed to create Setting window." << std::endl;
+		LOG_ERROR << "Failed to create Setting window.";
 	}
 }
 
 void Aras::resetAirportsList()
 {
-	std::cout << "Resetting airports list..." << std::endl;
+	LOG_INFO << "Resetting airports list...";
 }
 
 void Aras::saveToken(const std::string& token)
@@ -304,23 +285,33 @@ void Aras::addFIR(const std::string& fir)
 	m_dataManager->addFIRconfig(fir);
 }
 
-void Aras::downloadFiles(const std::string& setupUrl, const std::string& msiUrl)
+bool Aras::downloadFiles(const ReleaseInfo& release)
 {
-	std::ofstream setupOut("ARASsetup.exe", std::ios::binary);
-	m_loadingWindow->setText("ARASsetup.exe");
-	bool success = downloadInstaller(setupOut, setupUrl);
-	setupOut.close();
-	if (!success) {
-		if (std::remove("ARASsetup.exe") != 0) std::cerr << "Error deleting file" << std::endl;
+	FileDownload setup(release.setupUrl, "ARASsetup.exe", release.tag, release.setupSha256);
+	FileDownload msi(release.msiUrl, "ARASsetup.msi", release.tag, release.msiSha256);
+	setup.start();
+	msi.start();
+	m_loadingWindow->setText("ARASsetup.exe, ARASsetup.msi");
+
+	// The transfers run on their own threads, the window only reads their counters
+	while (!setup.isDone() || !msi.isDone()) {
+		uint64_t total = setup.getTotal() + msi.getTotal();
+		if (total > 0) {
+			m_loadingWindow->setProgress(100.f * static_cast<float>(setup.getReceived() + msi.getReceived()) / static_cast<float>(total));
+		}
+		while (const std::optional<sf::Event> event = m_loadingWindow->pollWindowEvent()) {
+			m_loadingWindow->processEvents(*event);
+		}
+		if (m_loadingWindow->isOpen()) {
+			m_loadingWindow->render();
+		}
+		std::this_thread::sleep_for(DOWNLOAD_PROGRESS_INTERVAL);
 	}
-
-	std::ofstream msiOut("ARASsetup.msi", std::ios::binary);
-	m_loadingWindow->setText("ARASsetup.msi");
-	success = downloadInstaller(msiOut, msiUrl);
-	msiOut.close();
-	if (!success) {
-		if (std::remove("ARASsetup.msi") != 0) std::cerr << "Error deleting file" << std::endl;
+	m_loadingWindow->setProgress(100.f);
+	if (m_loadingWindow->isOpen()) {
+		m_loadingWindow->render();
 	}
+	return setup.succeeded() && msi.succeeded();
 }
 
 void Aras::launchInstaller()
@@ -335,53 +326,18 @@ void Aras::launchInstaller()
 	shEx.nShow = SW_SHOWNORMAL;
 
 	if (!ShellExecuteExA(&shEx)) {
-		std::cerr << "Failed to launch installer, error: " << GetLastError() << std::endl;
+		LOG_ERROR << "Failed to launch installer, error: " << GetLastError();
 		return;
 	}
 
 	CloseHandle(shEx.hProcess);
 
-	std::cerr << "Installer launched, exiting ARAS." << std::endl;
-	ExitProcess(0);
-}
-
-RunwayData Aras::assignAirportRunway(const std::string& airport, const WindData& windData)
-{
-	// Add connected airports logic
-	constexpr double PI = 3.14159265358979323846;
-	std::vector<RunwayData> runwaysData = m_dataManager->getAirportRunwaysData(airport);
-
-	int alpha = std::abs(windData.windDirection - runwaysData[0].heading);
-	if (alpha > 180) alpha = 360 - alpha;
-
-	double tailWindComponent = windData.windSpeed * std::cos(alpha * PI / 180.0) < 0 ? windData.windSpeed * std::cos(alpha * PI / 180.0) : 0;
-
-	if (tailWindComponent < -runwaysData[0].preferential) { // Assume that the preferential runway is always the first one in the json
-		return runwaysData[1];
-	}
-	else {
-		return runwaysData[0];
-	}
-}
-
-std::vector<std::string> Aras::formatRunwayOutput(const RunwayData& runwaysData)
-{
-	std::string standardOutput = "ACTIVE_RUNWAY:" + runwaysData.airport + ":";
-	std::vector<std::string> output;
-
-	output.emplace_back(standardOutput + runwaysData.depRunway + ":1");
-	output.emplace_back(standardOutput + runwaysData.arrRunway + ":0");
-
-	if (runwaysData.has4rwys) {
-		output.emplace_back(standardOutput + runwaysData.depRunwayBis + ":1");
-		output.emplace_back(standardOutput + runwaysData.arrRunwayBis + ":0");
-	}
-
-	return output;
-}
+	// ExitProcess skips the destructors, save the config and wind snapshot first
+	shutdown();
+	m_runwayAssigner.reset();
+	m_dataManager.reset();
 
-std::vector<std::string> Aras::formatActiveAirport(const std::string& airport)
-{
-	std::string activeAirportText = "ACTIVE_AIRPORT:" + airport + ":";
-	return std::vector<std::string>{activeAirportText + "1", activeAirportText + "0"};
-}
+	LOG_INFO << "Installer launched, exiting ARAS.";
+	Logger::instance().stop();
+	ExitProcess(0);
+}
\ No newline at end of file
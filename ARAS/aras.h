@@ -4,21 +4,17 @@
 
 #include "GuiWindow.h"
 #include "DataManager.h"
+#include "RunwayAssigner.h"
 #include "SoundSystem.h"
+#include "WorkerPool.h"
+#include "CompletionQueue.h"
+#include "RefreshScheduler.h"
+#include "LoopWaker.h"
+#include "UpdateChecker.h"
+#include "MetricsServer.h"
 
 constexpr const char* ARAS_VERSION = "v1.0.3";
 
-struct RunwayData {
-	std::string airport;
-	bool has4rwys = false;
-	std::string depRunway;
-	std::string arrRunway;
-	std::string depRunwayBis;
-	std::string arrRunwayBis;
-	int heading = 0;
-	int preferential = 0;
-};
-
 class Aras {
 public:
 	Aras();
@@ -38,34 +34,44 @@ public:
 	std::string getTokenConfig() const { return m_dataManager->getToken(); }
 	bool getTokenValidity() const { return m_dataManager->isTokenValid(); }
 
-	bool newVersionAvailable(std::string& setupUrl, std::string& msiUrl);
 	bool isRwyFileFound() const { return std::filesystem::exists(m_dataManager->getConfigPath() / "rwydata.json"); }
 	bool isConfigFileFound() const { return std::filesystem::exists(m_dataManager->getConfigPath() / "config.json"); }
-	bool downloadInstaller(std::ofstream& out, const std::string& url);
 
 	void assignRunways(const std::string& fir);
+	bool isAssigning() const { return m_assigning; }
+	// Re-runs the assignment of the FIR after every METAR issuance until disabled
+	void setAutoRefresh(bool enabled, const std::string& fir);
+	bool isAutoRefreshing() const { return m_refreshScheduler.isRunning(); }
 	void openSettings();
 	void resetAirportsList();
 	void saveToken(const std::string& token);
 	void updateAirportsList(std::string fir, std::string airports);
 	void saveRwyLocation(const std::filesystem::path path);
 	void addFIR(const std::string& fir);
-	void downloadFiles(const std::string& setupUrl, const std::string& msiUrl);
+	// Downloads and starts the installer of the release found by the update check
+	void installUpdate();
+	bool downloadFiles(const ReleaseInfo& release);
 	void launchInstaller();
 
-	RunwayData assignAirportRunway(const std::string& airport, const WindData& windData);
-	std::vector<std::string> formatRunwayOutput(const RunwayData& runwayData);
-	std::vector<std::string> formatActiveAirport(const std::string& airport);
-
 private:
+	void processAssignmentEvents();
+	void processUpdateCheck();
+	void postAssignmentEvent(AssignmentEvent&& event); // from the assignment worker
+
 	std::unique_ptr<DataManager> m_dataManager;
+	std::unique_ptr<RunwayAssigner> m_runwayAssigner;
 	std::unique_ptr<SoundPlayer> m_soundPlayer;
 	std::thread m_renderThread;
 	bool m_stop = false;
 
-	std::string m_setupUrl;
-	std::string m_msiUrl;
-	bool m_newVersion = false;
+	LoopWaker m_loopWaker;
+	std::unique_ptr<WorkerPool> m_assignmentWorker;
+	CompletionQueue<AssignmentEvent> m_assignmentEvents;
+	bool m_assigning = false; // GUI thread only
+	RefreshScheduler m_refreshScheduler; // declared after the worker it submits to
+	std::future<std::optional<ReleaseInfo>> m_updateCheck; // wakes m_loopWaker when done
+	ReleaseInfo m_release;
+	MetricsServer m_metricsServer;
 
 	std::vector<std::unique_ptr<GuiWindow>> m_windows;
 	std::vector<std::unique_ptr<GuiWindow>> newWindows;
@@ -1,12 +1,15 @@
 #include "GuiWindow.h"
 #include "Aras.h"
+#include "Logger.h"
 
 GuiWindow::GuiWindow(unsigned int width, unsigned int height, const std::string& title, Aras* aras, bool hideControls)
 	: m_width(width), m_height(height), m_title(title), m_aras(aras), m_hideControls(hideControls)
 #ifdef _WIN32
 	, m_dragging(false), m_hwnd(nullptr), m_clickOffset{ 0, 0 }
 #endif
-{}
+{
+	m_gui.setDrawingUpdatesTime(false); // needsRedraw() updates it
+}
 
 GuiWindow::~GuiWindow()
 {
@@ -33,16 +36,12 @@ bool GuiWindow::createWindow()
 #endif
 
 	// Loading dependencies
-	if (m_icon.loadFromFile("ressources/images/icon.png")) {
-		//LOG
-	}
-	m_window.setIcon(m_icon);
-
-	if (!m_font.openFromFile("ressources/fonts/arial.ttf")) {
-		//LOG	
+	m_icon = ResourceCache::getImage("ressources/images/icon.png");
+	if (m_icon) {
+		m_window.setIcon(*m_icon);
 	}
-
-	m_gui.setFont("ressources/fonts/arial.ttf");
+	m_font = ResourceCache::getFont("ressources/fonts/arial.ttf");
+	m_gui.setFont(ResourceCache::getGuiFont("ressources/fonts/arial.ttf"));
 
 	return true;
 }
@@ -68,12 +67,10 @@ void GuiWindow::createBaseWindowLayout(const std::string& title)
 	float dragAreaHeight = 30;
 
 	// Icon
-	bool success = iconTexture.resize({ m_icon.getSize().x, m_icon.getSize().y });
-	if (success) {
-		iconTexture.update(m_icon);
-		iconTexture.setSmooth(true);
-		sf::Sprite iconSprite(iconTexture);
-		float scale = dragAreaHeight * 0.7f / static_cast<float>(m_icon.getSize().x);
+	m_iconTexture = ResourceCache::getTexture("ressources/images/icon.png");
+	if (m_iconTexture) {
+		sf::Sprite iconSprite(*m_iconTexture);
+		float scale = dragAreaHeight * 0.7f / static_cast<float>(m_iconTexture->getSize().x);
 		iconSprite.setScale({ scale, scale });
 		iconSprite.setOrigin(iconSprite.getLocalBounds().getCenter());
 		iconSprite.setPosition({ dragAreaHeight / 2, dragAreaHeight / 2 });
@@ -81,11 +78,13 @@ void GuiWindow::createBaseWindowLayout(const std::string& title)
 	}
 
 	// Title Text
-	sf::Text titleText(m_font, title, 25);
-	titleText.setFillColor(sf::Color::White);
-	titleText.setOrigin(titleText.getLocalBounds().getCenter());
-	titleText.setPosition({ static_cast<float>(m_width / 2), static_cast<float>(dragAreaHeight / 2) });
-	m_drawables.push_back(std::move(std::make_unique<sf::Text>(titleText)));
+	if (m_font) {
+		sf::Text titleText(*m_font, title, 25);
+		titleText.setFillColor(sf::Color::White);
+		titleText.setOrigin(titleText.getLocalBounds().getCenter());
+		titleText.setPosition({ static_cast<float>(m_width / 2), static_cast<float>(dragAreaHeight / 2) });
+		m_drawables.push_back(std::move(std::make_unique<sf::Text>(titleText)));
+	}
 
 	// Version Text
 	m_versionText = tgui::Label::create(ARAS_VERSION);
@@ -134,9 +133,13 @@ std::optional<sf::Event> GuiWindow::pollWindowEvent()
 
 void GuiWindow::processEvents(const sf::Event& event)
 {
+	m_dirty = true;
 	if (event.is<sf::Event::Closed>()) {
 		m_window.close();
 	}
+	if (event.is<sf::Event::Resized>()) {
+		m_chromeDirty = true;
+	}
 
 	// Dragging the window
 	const sf::Event::MouseButtonPressed* mouseEvent = event.getIf<sf::Event::MouseButtonPressed>();
@@ -161,19 +164,57 @@ void GuiWindow::processEvents(const sf::Event& event)
 	m_gui.handleEvent(event);
 }
 
+bool GuiWindow::needsRedraw()
+{
+	if (m_gui.updateTime()) {
+		m_dirty = true;
+	}
+#ifdef _WIN32
+	return m_dirty || m_dragging;
+#else
+	return m_dirty;
+#endif
+}
+
 void GuiWindow::render()
 {
+	m_dirty = false;
 	m_window.clear(sf::Color::Transparent);
 
 	m_gui.draw();
-	for (const auto& drawable : m_drawables) {
-		m_window.draw(*drawable);
+	if (m_chromeDirty) {
+		m_chromeCached = renderChrome();
+		m_chromeDirty = false;
+	}
+	if (m_chromeCached) {
+		// The texture holds premultiplied colors, blending them by alpha again would darken the text edges
+		const sf::BlendMode premultipliedAlpha(sf::BlendMode::Factor::One, sf::BlendMode::Factor::OneMinusSrcAlpha);
+		m_window.draw(sf::Sprite(m_chromeTexture.getTexture()), premultipliedAlpha);
+	}
+	else {
+		for (const auto& drawable : m_drawables) {
+			m_window.draw(*drawable);
+		}
 	}
 
 	updateDrag();
 	m_window.display();
 }
 
+bool GuiWindow::renderChrome()
+{
+	if (!m_chromeTexture.resize(m_window.getSize())) {
+		LOG_WARNING << "Failed to create the window chrome texture, drawing it every frame.";
+		return false;
+	}
+	m_chromeTexture.clear(sf::Color::Transparent);
+	for (const auto& drawable : m_drawables) {
+		m_chromeTexture.draw(*drawable);
+	}
+	m_chromeTexture.display();
+	return true;
+}
+
 void GuiWindow::focus() const
 {
 #ifdef _WIN32
@@ -421,6 +462,9 @@ void GuiMainWindow::createMainWindowWidgets()
 			}
 			std::string selectedFIR = m_firSelector->getSelectedItem().toStdString();
 			updateAirportListWidget(selectedFIR, false);
+			if (m_autoRefreshCheckBox && m_autoRefreshCheckBox->isChecked()) {
+				m_aras->setAutoRefresh(true, selectedFIR);
+			}
 		}
 		});
 	m_row3->add(m_firSelector);
@@ -509,11 +553,34 @@ void GuiMainWindow::createMainWindowWidgets()
 	// Runway Assign Button
 	m_rwyAssignButton = createButton("Assign runways", { m_width * 0.35f, m_height * 0.85f }, { 165, 30 }, arasButtonColors);
 	m_rwyAssignButton->onClick([this] {
+		if (m_aras->isAssigning()) return;
 		m_aras->assignRunways(m_firSelector->getSelectedItem().toStdString());
-		if (m_aras->getTokenValidity()) setTokenStatusVerified();
-		else setTokenStatusInvalid();
 	});
 	m_row4->add(m_rwyAssignButton);
+
+	// Auto refresh toggle
+	m_autoRefreshCheckBox = tgui::CheckBox::create("Auto refresh");
+	m_autoRefreshCheckBox->setTextSize(16);
+	m_autoRefreshCheckBox->setSize({ 20, 20 });
+	m_autoRefreshCheckBox->getRenderer()->setTextColor(tgui::Color::White);
+	m_autoRefreshCheckBox->getRenderer()->setTextColorHover(tgui::Color::White);
+	m_autoRefreshCheckBox->setMouseCursor(tgui::Cursor::Type::Hand);
+	m_autoRefreshCheckBox->onChange([this](bool checked) {
+		m_aras->setAutoRefresh(checked, m_firSelector->getSelectedItem().toStdString());
+	});
+	tgui::Panel::Ptr autoRefreshPanel = tgui::Panel::create({ 140, 30 });
+	autoRefreshPanel->getRenderer()->setBackgroundColor(tgui::Color::Transparent);
+	autoRefreshPanel->getRenderer()->setPadding({ 10, 5, 0, 0 });
+	autoRefreshPanel->add(m_autoRefreshCheckBox);
+	m_row4->add(autoRefreshPanel);
+
+	// Assignment progress
+	m_assignStatusText = tgui::Label::create("");
+	m_assignStatusText->setTextSize(16);
+	m_assignStatusText->setWidth(300);
+	m_assignStatusText->getRenderer()->setTextColor(tgui::Color::White);
+	m_assignStatusText->getRenderer()->setPadding({ 10, 6, 0, 0 });
+	m_row4->add(m_assignStatusText);
 	m_verticalLayout->add(m_row4);
 	m_verticalLayout->addSpace(0.5);
 
@@ -551,19 +618,75 @@ void GuiMainWindow::updateAirportListWidget(std::string fir, bool def=false)
 	m_airportList->setText(airportListText);
 }
 
-void GuiWindow::loadDependencies()
+void GuiMainWindow::onAssignmentEvent(const AssignmentEvent& event)
 {
-	// Loading dependencies
-	if (m_icon.loadFromFile("ressources/images/icon.png")) {
-		//LOG
+	std::string progress = "(" + std::to_string(event.completed) + "/" + std::to_string(event.total) + ")";
+	switch (event.type) {
+	case AssignmentEvent::Type::Started:
+		m_rwyAssignButton->setEnabled(false);
+		m_rwyAssignButton->setText("Assigning...");
+		m_assignStatusText->setText(event.fir + ": fetching weather " + progress);
+		m_assignStatusText->getRenderer()->setTextColor(tgui::Color::White);
+		break;
+	case AssignmentEvent::Type::AirportAssigned:
+		m_assignStatusText->setText(event.airport + " " + event.detail + " " + progress);
+		break;
+	case AssignmentEvent::Type::AirportFailed:
+		m_assignStatusText->setText(event.airport + " skipped, " + event.detail + " " + progress);
+		break;
+	case AssignmentEvent::Type::Finished: {
+		m_rwyAssignButton->setEnabled(true);
+		m_rwyAssignButton->setText("Assign runways");
+		if (event.total == 0) {
+			m_assignStatusText->setText(event.fir + ": no airports");
+			m_assignStatusText->getRenderer()->setTextColor(Colors::Yellow);
+		}
+		else if (event.success && !event.rwyChanged) {
+			m_assignStatusText->setText(event.fir + " checked, runways unchanged");
+			m_assignStatusText->getRenderer()->setTextColor(Colors::Green);
+		}
+		else if (event.success) {
+			std::string seconds = std::to_string(event.seconds);
+			m_assignStatusText->setText(event.fir + " assigned in " + seconds.substr(0, seconds.find('.') + 3) + "s");
+			m_assignStatusText->getRenderer()->setTextColor(Colors::Green);
+		}
+		else {
+			m_assignStatusText->setText(event.fir + ": failed to write .rwy file");
+			m_assignStatusText->getRenderer()->setTextColor(tgui::Color::Red);
+		}
+		if (m_aras->getTokenValidity()) setTokenStatusVerified();
+		else setTokenStatusInvalid();
+		break;
 	}
-	m_window.setIcon(m_icon);
-
-	if (!m_font.openFromFile("ressources/fonts/font.ttf")) {
-		//LOG	
 	}
+}
 
-	m_gui.setFont("ressources/fonts/font.ttf");
+void GuiMainWindow::onUpdateAvailable(const std::string& version)
+{
+	tgui::MessageBox::Ptr updatePrompt = tgui::MessageBox::create("ARAS Updater",
+		"ARAS " + version + " is available. Do you want to install it now?", { "Install", "Later" });
+	updatePrompt->setPosition("(&.size - size) / 2");
+	updatePrompt->onButtonPress([this, prompt = updatePrompt.get()](const tgui::String& button) {
+		prompt->close();
+		if (button == "Install") {
+			m_aras->installUpdate();
+		}
+		else {
+			LOG_INFO << "User chose not to install the new version now.";
+		}
+	});
+	m_gui.add(updatePrompt);
+}
+
+void GuiWindow::loadDependencies()
+{
+	// Loading dependencies, only the first window reads them from disk
+	m_icon = ResourceCache::getImage("ressources/images/icon.png");
+	if (m_icon) {
+		m_window.setIcon(*m_icon);
+	}
+	m_font = ResourceCache::getFont("ressources/fonts/font.ttf");
+	m_gui.setFont(ResourceCache::getGuiFont("ressources/fonts/font.ttf"));
 }
 
 void GuiMainWindow::setTokenStatusVerified()
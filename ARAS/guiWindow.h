@@ -6,6 +6,7 @@
 
 #include "Colors.h"
 #include "RoundedRectangle.h"
+#include "ResourceCache.h"
 
 #ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN
@@ -14,6 +15,7 @@
 #endif
 
 class Aras;
+struct AssignmentEvent;
 
 
 struct ButtonColors {
@@ -28,7 +30,7 @@ struct ButtonColors {
 class GuiWindow {
 public:
 	GuiWindow(unsigned int width, unsigned int height, const std::string& title, Aras* aras, bool hideControls=false);
-	~GuiWindow();
+	virtual ~GuiWindow();
 
 	GuiWindow(const GuiWindow&) = delete;
 	GuiWindow& operator=(const GuiWindow&) = delete;
@@ -40,6 +42,11 @@ public:
 	void createBaseWindowLayout(const std::string& title);
 	std::optional<sf::Event> pollWindowEvent();
 	virtual void processEvents(const sf::Event& event);
+	virtual void onAssignmentEvent(const AssignmentEvent&) {}
+	virtual void onUpdateAvailable(const std::string&) {}
+	// Advances TGUI timers and animations, true when the window has to be drawn again
+	bool needsRedraw();
+	void invalidate() { m_dirty = true; }
 	void render();
 	void focus() const;
 	bool isOpen() const;
@@ -52,6 +59,7 @@ public:
 protected:
 	tgui::Button::Ptr createButton(const std::string& buttonText, tgui::Vector2f position, tgui::Vector2f size, ButtonColors colors);
 	void loadDependencies();
+	bool renderChrome();
 
 
 protected:
@@ -65,11 +73,16 @@ protected:
 	tgui::Button::Ptr m_closeButton;
 	tgui::Button::Ptr m_minimiseButton;
 	tgui::Label::Ptr m_versionText;
+	// Shared with the other windows through ResourceCache, outlive the drawables using them
+	std::shared_ptr<const sf::Texture> m_iconTexture;
+	std::shared_ptr<const sf::Image> m_icon;
+	std::shared_ptr<const sf::Font> m_font;
 	std::vector <std::unique_ptr<sf::Drawable>> m_drawables;
-	sf::Texture iconTexture;
-	sf::Image m_icon;
-	sf::Font m_font;
+	sf::RenderTexture m_chromeTexture; // m_drawables, drawn once and blitted over the gui
+	bool m_chromeDirty = true;
+	bool m_chromeCached = false;
 	bool m_hideControls = false;
+	bool m_dirty = true; // drawn only after input or a change
 
 #ifdef _WIN32
 	HWND m_hwnd = nullptr;
@@ -86,6 +99,8 @@ public:
 	bool createWindow() override;
 	void createMainWindowWidgets();
 	void updateAirportListWidget(std::string fir, bool def);
+	void onAssignmentEvent(const AssignmentEvent& event) override;
+	void onUpdateAvailable(const std::string& version) override;
 
 private:
 	void setTokenStatusVerified();
@@ -110,6 +125,7 @@ private:
 	tgui::Label::Ptr m_tokenStatusText;
 	tgui::Label::Ptr m_confStatusText;
 	tgui::Label::Ptr m_rwyStatusText;
+	tgui::Label::Ptr m_assignStatusText;
 
 	tgui::EditBox::Ptr m_tokenEntry;
 
@@ -120,6 +136,7 @@ private:
 
 	tgui::Button::Ptr m_rwyLocationButton;
 	tgui::Button::Ptr m_rwyAssignButton;
+	tgui::CheckBox::Ptr m_autoRefreshCheckBox;
 
 	tgui::Button::Ptr m_settingsButton;
 
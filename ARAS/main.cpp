@@ -1,8 +1,7 @@
 #pragma once
-#include <iostream>
-#include <fstream>
 
 #include "Aras.h"
+#include "Logger.h"
 
 
 int WINAPI WinMain(
@@ -12,20 +11,18 @@ int WINAPI WinMain(
     int       nShowCmd
 )
 {
-	// Initialize logging
-	std::ofstream logFile("ARAS_log.txt");
-	if (logFile.is_open()) {
-		logFile << "----- ARAS Log Started -----" << std::endl;
-		std::cerr.rdbuf(logFile.rdbuf());
-		std::cout.rdbuf(logFile.rdbuf());
-		std::cerr << "ARAS version: " << ARAS_VERSION << std::endl;
-	}
-	else {
-		std::cerr << "Failed to open log file." << std::endl;
-	}
+	// Initialize logging, the previous session's log is kept as ARAS_log.1.txt
+	Logger::Options logOptions;
+	logOptions.file = "ARAS_log.txt";
+	Logger::instance().start(logOptions);
+	LOG_INFO << "----- ARAS Log Started -----";
+	LOG_INFO << "ARAS version: " << ARAS_VERSION;
 
-	Aras aras;
+	{
+		Aras aras;
+		LOG_INFO << "Closing log file.";
+	}
 
-	std::cerr << "Closing log file." << std::endl;
+	Logger::instance().stop();
     return 0;
 }
\ No newline at end of file
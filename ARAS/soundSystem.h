@@ -5,10 +5,11 @@
 #include <WinSock2.h>
 #include <Windows.h>
 #include <mmsystem.h>
-#include <iostream>
 #pragma comment(lib, "winmm.lib")
 #endif // _WIN32
 
+#include "Logger.h"
+
 class SoundPlayer {
 public:
 	SoundPlayer() = default;
@@ -23,7 +24,7 @@ public:
 
 inline void SoundPlayer::playSound(const std::string& filePath) {
 	if (!PlaySoundA(filePath.c_str(), NULL, SND_FILENAME | SND_ASYNC)) {
-		std::cerr << "Failed to play sound: " << filePath << std::endl;
+		LOG_ERROR << "Failed to play sound: " << filePath;
 	}
 }
 
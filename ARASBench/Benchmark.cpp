@@ -0,0 +1,56 @@
+#include "Benchmark.h"
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<uint64_t> allocationCount{ 0 };
+std::atomic<uint64_t> allocationBytes{ 0 };
+
+} // namespace
+
+// Array and nothrow forms end up here through the default library versions
+void* operator new(std::size_t size)
+{
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+	allocationBytes.fetch_add(size, std::memory_order_relaxed);
+	if (void* pointer = std::malloc(size == 0 ? 1 : size)) {
+		return pointer;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept
+{
+	std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+	std::free(pointer);
+}
+
+AllocationCounts allocationCounts()
+{
+	AllocationCounts counts;
+	counts.count = allocationCount.load(std::memory_order_relaxed);
+	counts.bytes = allocationBytes.load(std::memory_order_relaxed);
+	return counts;
+}
+
+void printHeader()
+{
+	std::cout << std::left << std::setw(16) << "dataset" << std::setw(34) << "benchmark" << std::right
+		<< std::setw(12) << "ops" << std::setw(14) << "ns/op" << std::setw(12) << "allocs/op" << std::setw(14) << "bytes/op" << std::endl;
+}
+
+void printResult(const std::string& dataset, const BenchmarkResult& result)
+{
+	std::cout << std::left << std::setw(16) << dataset << std::setw(34) << result.name << std::right << std::fixed
+		<< std::setw(12) << result.ops
+		<< std::setw(14) << std::setprecision(1) << result.nsPerOp
+		<< std::setw(12) << std::setprecision(2) << result.allocsPerOp
+		<< std::setw(14) << std::setprecision(1) << result.bytesPerOp << std::defaultfloat << std::endl;
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <string>
+#include <chrono>
+#include <atomic>
+#include <algorithm>
+#include <cstdint>
+
+// Heap allocations of the whole process, counted by the operator new of this executable
+struct AllocationCounts {
+	uint64_t count = 0;
+	uint64_t bytes = 0;
+};
+AllocationCounts allocationCounts();
+
+struct BenchmarkResult {
+	std::string name;
+	uint64_t ops = 0;
+	double nsPerOp = 0.0;
+	double allocsPerOp = 0.0;
+	double bytesPerOp = 0.0;
+};
+
+// Keeps a benchmarked result alive without the cost of a volatile store per op
+inline std::atomic<size_t> benchmarkSink{ 0 };
+
+// Calls op(i) with i = 0, 1, 2... in doubling batches until the budget is spent,
+// after one warm-up call that is not measured
+template <typename F>
+BenchmarkResult runBenchmark(const std::string& name, F&& op, std::chrono::milliseconds budget = std::chrono::milliseconds{ 300 })
+{
+	using Clock = std::chrono::steady_clock;
+	op(uint64_t{ 0 });
+
+	BenchmarkResult result;
+	result.name = name;
+	uint64_t batch = 1;
+	AllocationCounts before = allocationCounts();
+	Clock::time_point start = Clock::now();
+	Clock::duration elapsed{};
+	while (true) {
+		for (uint64_t b = 0; b < batch; ++b) {
+			op(result.ops++);
+		}
+		elapsed = Clock::now() - start;
+		if (elapsed >= budget) {
+			break;
+		}
+		batch = std::min<uint64_t>(batch * 2, 1 << 20);
+	}
+	AllocationCounts after = allocationCounts();
+
+	double ops = static_cast<double>(result.ops);
+	result.nsPerOp = std::chrono::duration<double, std::nano>(elapsed).count() / ops;
+	result.allocsPerOp = static_cast<double>(after.count - before.count) / ops;
+	result.bytesPerOp = static_cast<double>(after.bytes - before.bytes) / ops;
+	return result;
+}
+
+void printHeader();
+void printResult(const std::string& dataset, const BenchmarkResult& result);
+
@@ -0,0 +1,129 @@
+#include "HotPathBench.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <random>
+#include <memory>
+#include <system_error>
+#include <algorithm>
+
+#include "Benchmark.h"
+#include "DataManager.h"
+#include "RunwayAssigner.h"
+#include "RunwayIndex.h"
+#include "Logger.h"
+#include "ScenarioGenerator.h"
+
+namespace {
+
+std::string readFile(const std::filesystem::path& path)
+{
+	std::ifstream file(path, std::ios::binary);
+	std::ostringstream content;
+	content << file.rdbuf();
+	return content.str();
+}
+
+void runDataset(const std::string& dataset, const std::string& rwyDataText, const std::filesystem::path& directory)
+{
+	std::error_code error;
+	std::filesystem::remove_all(directory, error);
+	std::filesystem::create_directories(directory);
+	{
+		std::ofstream file(directory / "rwydata.json", std::ios::binary);
+		file << rwyDataText;
+	}
+
+	nlohmann::json rwyData = nlohmann::json::parse(rwyDataText);
+	std::vector<std::string> airports;
+	for (const auto& [oaci, value] : rwyData.items()) {
+		airports.push_back(oaci);
+	}
+	if (airports.empty()) {
+		std::cerr << dataset << ": no airport in the runway data." << std::endl;
+		return;
+	}
+
+	auto dataManager = std::make_unique<DataManager>(directory);
+	dataManager->setRwyFileOverride(directory / "bench.rwy");
+	dataManager->loadRunwayData();
+	RunwayAssigner assigner(*dataManager);
+
+	std::mt19937 rng(7);
+	std::uniform_int_distribution<int> direction(0, 36);
+	std::uniform_int_distribution<int> speed(0, 35);
+	std::vector<WindData> winds(1024);
+	for (auto& wind : winds) {
+		wind = WindData{ direction(rng) * 10, speed(rng), 0 };
+	}
+
+	std::vector<RunwayData> runwayData;
+	std::vector<std::string> runways;
+	for (size_t i = 0; i < airports.size(); ++i) {
+		runwayData.push_back(assigner.assignAirportRunway(airports[i], winds[i % winds.size()]));
+		std::vector<std::string> active = RunwayAssigner::formatActiveAirport(airports[i]);
+		std::vector<std::string> assigned = RunwayAssigner::formatRunwayOutput(runwayData.back());
+		runways.insert(runways.end(), active.begin(), active.end());
+		runways.insert(runways.end(), assigned.begin(), assigned.end());
+	}
+	// Same size, different content: every other write has to replace the file
+	std::vector<std::string> changedRunways = runways;
+	changedRunways.back().back() = changedRunways.back().back() == '0' ? '1' : '0';
+
+	printResult(dataset, runBenchmark("parse rwydata.json", [&](uint64_t) {
+		benchmarkSink += nlohmann::json::parse(rwyDataText).size();
+	}));
+	printResult(dataset, runBenchmark("RunwayIndex::build", [&](uint64_t) {
+		RunwayIndex index;
+		index.build(rwyData);
+		benchmarkSink += index.configCount();
+	}));
+	printResult(dataset, runBenchmark("DataManager::loadRunwayData", [&](uint64_t) {
+		benchmarkSink += dataManager->loadRunwayData();
+	}));
+	printResult(dataset, runBenchmark("getAirportRunwaysData", [&](uint64_t i) {
+		benchmarkSink += dataManager->getAirportRunwaysData(airports[i % airports.size()]).size();
+	}));
+	printResult(dataset, runBenchmark("assignAirportRunway", [&](uint64_t i) {
+		benchmarkSink += assigner.assignAirportRunway(airports[i % airports.size()], winds[i % winds.size()]).depRunway.size();
+	}));
+	printResult(dataset, runBenchmark("formatActiveAirport", [&](uint64_t i) {
+		benchmarkSink += RunwayAssigner::formatActiveAirport(airports[i % airports.size()]).size();
+	}));
+	printResult(dataset, runBenchmark("formatRunwayOutput", [&](uint64_t i) {
+		benchmarkSink += RunwayAssigner::formatRunwayOutput(runwayData[i % runwayData.size()]).size();
+	}));
+	printResult(dataset, runBenchmark("outputRunways (unchanged)", [&](uint64_t) {
+		benchmarkSink += static_cast<int>(dataManager->outputRunways(runways));
+	}));
+	printResult(dataset, runBenchmark("outputRunways (rewritten)", [&](uint64_t i) {
+		benchmarkSink += static_cast<int>(dataManager->outputRunways(i % 2 == 0 ? changedRunways : runways));
+	}));
+
+	dataManager.reset();
+	std::filesystem::remove_all(directory, error);
+}
+
+} // namespace
+
+int runHotPathSuite(const std::filesystem::path& shippedRwyData, const std::vector<size_t>& syntheticSizes)
+{
+	// Measures the work itself, not the log lines it would queue
+	Logger::instance().setLevel(LogLevel::Error);
+	std::filesystem::path directory = std::filesystem::temp_directory_path() / "aras-bench";
+
+	printHeader();
+	if (std::filesystem::exists(shippedRwyData)) {
+		runDataset("shipped", readFile(shippedRwyData), directory);
+	}
+	else {
+		std::cerr << "Skipping the shipped data, " << shippedRwyData.string() << " not found." << std::endl;
+	}
+
+	for (size_t size : syntheticSizes) {
+		std::string name = size % 1000 == 0 ? std::to_string(size / 1000) + "k" : std::to_string(size);
+		ScenarioGenerator generator({ size, std::max<size_t>(size / 100, 1), 42 });
+		runDataset("synthetic " + name, generator.makeRwyData().dump(), directory);
+	}
+	return 0;
+}
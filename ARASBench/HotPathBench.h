@@ -0,0 +1,8 @@
+#pragma once
+#include <filesystem>
+#include <vector>
+
+// ns/op, allocations/op and bytes/op of the assignment hot path: rwydata.json
+// parsing, runway lookups, selection, .rwy text building and the .rwy write.
+// Runs on the shipped runway data and on aras-gen data of each size.
+int runHotPathSuite(const std::filesystem::path& shippedRwyData, const std::vector<size_t>& syntheticSizes);
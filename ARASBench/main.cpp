@@ -0,0 +1,155 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <filesystem>
+#include <stdexcept>
+
+#include "RunwayIndex.h"
+#include "RunwaySelector.h"
+#include "WindKernel.h"
+#include "Benchmark.h"
+#include "HotPathBench.h"
+#include "ScenarioGenerator.h"
+
+// Compares RunwaySelector::select, the per airport path used by Aras, with
+// every WindKernel path on the same airports and winds. Without a file, the
+// airports come from ScenarioGenerator, the same data as aras-gen.
+static int runKernelComparison(size_t airportCount, const char* rwyDataPath)
+{
+	std::mt19937 rng(42);
+
+	nlohmann::json rwyData;
+	if (rwyDataPath != nullptr) {
+		std::ifstream file(rwyDataPath);
+		if (!file.is_open()) {
+			std::cerr << "Could not open " << rwyDataPath << std::endl;
+			return 1;
+		}
+		rwyData = nlohmann::json::parse(file, nullptr, false);
+	}
+	else {
+		ScenarioGenerator generator({ airportCount, std::max<size_t>(airportCount / 100, 1), 42 });
+		rwyData = generator.makeRwyData();
+	}
+
+	RunwayIndex index;
+	if (!index.build(rwyData)) {
+		return 1;
+	}
+
+	// Real files are small, repeat their airports up to the requested count
+	std::vector<const AirportRunways*> airports;
+	airports.reserve(airportCount);
+	std::vector<const AirportRunways*> distinct;
+	for (const auto& [oaci, value] : rwyData.items()) {
+		if (const AirportRunways* airport = index.find(oaci)) distinct.push_back(airport);
+	}
+	if (distinct.empty()) {
+		std::cerr << "No airport in the runway data." << std::endl;
+		return 1;
+	}
+	for (size_t i = 0; i < airportCount; ++i) {
+		airports.push_back(distinct[i % distinct.size()]);
+	}
+
+	std::uniform_int_distribution<int> direction(0, 36);
+	std::uniform_int_distribution<int> speed(0, 35);
+	std::uniform_int_distribution<int> gust(0, 15);
+	std::vector<WindData> winds(airportCount);
+	std::vector<int32_t> directions(airportCount);
+	std::vector<float> speeds(airportCount);
+	std::vector<float> gusts(airportCount);
+	for (size_t i = 0; i < airportCount; ++i) {
+		WindData& wind = winds[i];
+		wind.windDirection = direction(rng) * 10; // 0 is VRB, about one wind in 37
+		wind.windSpeed = speed(rng);
+		int extra = gust(rng);
+		wind.windGust = extra > 10 ? wind.windSpeed + extra : 0;
+		directions[i] = wind.windDirection;
+		speeds[i] = static_cast<float>(wind.windSpeed);
+		gusts[i] = static_cast<float>(wind.windGust);
+	}
+
+	WindKernelTable table = WindKernel::buildTable(index, airports);
+	std::cout << airportCount << " airports, " << table.slotCount << " configuration slots, "
+		<< table.headingSlots << " runways per slot, best ISA " << WindKernel::isaName(WindKernel::bestIsa()) << std::endl;
+
+	const int rounds = static_cast<int>(std::max<size_t>(1, 2000000 / airportCount));
+	using Clock = std::chrono::steady_clock;
+
+	std::vector<int32_t> expected(airportCount);
+	auto start = Clock::now();
+	for (int round = 0; round < rounds; ++round) {
+		for (size_t i = 0; i < airportCount; ++i) {
+			expected[i] = static_cast<int32_t>(RunwaySelector::select(index.getConfigs(*airports[i]), winds[i]).configIndex);
+		}
+	}
+	double referenceNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / (static_cast<double>(rounds) * airportCount);
+	std::cout << "RunwaySelector::select " << referenceNs << " ns/airport" << std::endl;
+
+	bool agree = true;
+	for (WindKernel::Isa isa : { WindKernel::Isa::Scalar, WindKernel::Isa::Sse2, WindKernel::Isa::Avx2 }) {
+		if (static_cast<int>(isa) > static_cast<int>(WindKernel::bestIsa())) {
+			std::cout << "WindKernel " << WindKernel::isaName(isa) << " not supported on this CPU" << std::endl;
+			continue;
+		}
+
+		std::vector<int32_t> result(airportCount, -1);
+		start = Clock::now();
+		for (int round = 0; round < rounds; ++round) {
+			WindKernel::selectConfigs(table, directions, speeds, gusts, result, isa);
+		}
+		double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / (static_cast<double>(rounds) * airportCount);
+
+		size_t mismatches = 0;
+		for (size_t i = 0; i < airportCount; ++i) {
+			if (result[i] != expected[i]) ++mismatches;
+		}
+		if (mismatches != 0) agree = false;
+		std::cout << "WindKernel " << WindKernel::isaName(isa) << " " << ns << " ns/airport, x" << referenceNs / ns
+			<< ", " << mismatches << " mismatches" << std::endl;
+	}
+	return agree ? 0 : 2;
+}
+
+//   aras-bench [rwydata.json]
+//       hot path suite on the shipped runway data (default Config/rwydata.json)
+//       and on 1k, 10k and 100k synthetic airports
+//   aras-bench kernels [airports] [rwydata.json]
+//       RunwaySelector against the WindKernel paths
+static void printUsage()
+{
+	std::cout << "Usage: aras-bench [rwydata.json] | aras-bench kernels [airports] [rwydata.json]" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc > 1 && std::string(argv[1]) == "kernels") {
+		size_t airportCount = 10000;
+		if (argc > 2) {
+			try {
+				// stoul would wrap a negative count around
+				airportCount = argv[2][0] == '-' ? 0 : std::stoul(argv[2]);
+			}
+			catch (const std::logic_error&) {
+				airportCount = 0;
+			}
+			if (airportCount == 0) {
+				std::cerr << "Invalid airport count: " << argv[2] << std::endl;
+				printUsage();
+				return 2;
+			}
+		}
+		return runKernelComparison(airportCount, argc > 3 ? argv[3] : nullptr);
+	}
+	if (argc > 1 && (std::string(argv[1]) == "--help" || std::string(argv[1]) == "-h")) {
+		printUsage();
+		return 0;
+	}
+	std::filesystem::path shippedRwyData = argc > 1 ? argv[1] : "Config/rwydata.json";
+	return runHotPathSuite(shippedRwyData, { 1000, 10000, 100000 });
+}
@@ -0,0 +1,151 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <csignal>
+#include <cstdlib>
+
+#include "DataManager.h"
+#include "RunwayAssigner.h"
+#include "RefreshScheduler.h"
+#include "Logger.h"
+#include "Tracer.h"
+#include "MetricsServer.h"
+
+static std::atomic<bool> stopRequested{ false };
+
+static void onStopSignal(int)
+{
+	stopRequested = true;
+}
+
+// Headless runway assignment, same config.json / rwydata.json as the GUI.
+static void printUsage()
+{
+	std::cout << "Usage: aras-cli [--config DIR] [--output FILE] [--watch] [--log FILE] [--verbose] [--trace DIR] [--metrics PORT] [--provisional] (--fir FIR ... | --all | --list)\n"
+		<< "  --config DIR   directory holding config.json and rwydata.json (default: Documents/Aras)\n"
+		<< "  --output FILE  .rwy file to write instead of the one in config.json\n"
+		<< "  --fir FIR      FIR to assign, can be repeated\n"
+		<< "  --all          assign every configured FIR into one .rwy file\n"
+		<< "  --list         print the configured FIRs and exit\n"
+		<< "  --watch        keep running, refresh after every METAR issuance until interrupted\n"
+		<< "  --log FILE     also write the log to FILE, rotated when it grows\n"
+		<< "  --verbose      include debug messages in the log\n"
+		<< "  --trace DIR    write a Chrome trace of every assignment to DIR (chrome://tracing, ui.perfetto.dev)\n"
+		<< "  --metrics PORT serve Prometheus metrics on http://127.0.0.1:PORT/metrics (useful with --watch)\n"
+		<< "  --provisional  write runways from the wind snapshot first, then again once the METARs arrive" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+	std::filesystem::path configPath;
+	std::filesystem::path outputPath;
+	std::filesystem::path logPath;
+	std::filesystem::path tracePath;
+	int metricsPort = 0;
+	std::vector<std::string> firs;
+	bool all = false;
+	bool list = false;
+	bool watch = false;
+	bool verbose = false;
+	bool provisional = false;
+
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+		if (arg == "--config" && hasValue) configPath = argv[++i];
+		else if (arg == "--output" && hasValue) outputPath = argv[++i];
+		else if (arg == "--fir" && hasValue) firs.push_back(argv[++i]);
+		else if (arg == "--all") all = true;
+		else if (arg == "--list") list = true;
+		else if (arg == "--watch") watch = true;
+		else if (arg == "--log" && hasValue) logPath = argv[++i];
+		else if (arg == "--verbose") verbose = true;
+		else if (arg == "--trace" && hasValue) tracePath = argv[++i];
+		else if (arg == "--metrics" && hasValue) metricsPort = std::atoi(argv[++i]);
+		else if (arg == "--provisional") provisional = true;
+		else {
+			printUsage();
+			return arg == "--help" || arg == "-h" ? 0 : 2;
+		}
+	}
+	if (!list && !all && firs.empty()) {
+		printUsage();
+		return 2;
+	}
+
+	// Log lines go to the console from the logger thread, flushed before the program's own output
+	Logger::Options logOptions;
+	logOptions.file = logPath;
+	logOptions.console = true;
+	logOptions.level = verbose ? LogLevel::Debug : LogLevel::Info;
+	Logger::instance().start(logOptions);
+
+	auto loadStart = std::chrono::steady_clock::now();
+	std::unique_ptr<DataManager> dataManager = std::make_unique<DataManager>(configPath);
+	double loadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - loadStart).count();
+
+	Logger::instance().flush();
+	if (dataManager->getRunwayIndex()->airportCount() == 0) {
+		std::cerr << "No runway data found in " << (configPath.empty() ? dataManager->getConfigPath() : configPath).string() << std::endl;
+		return 1;
+	}
+	if (list) {
+		for (const auto& fir : dataManager->getFIRs()) {
+			std::cout << fir << std::endl;
+		}
+		return 0;
+	}
+	if (all) {
+		firs = dataManager->getFIRs();
+	}
+	if (!outputPath.empty()) {
+		dataManager->setRwyFileOverride(outputPath);
+	}
+	if (!tracePath.empty()) {
+		dataManager->setTraceDirectoryOverride(tracePath);
+		Tracer::setThreadName("Main");
+	}
+
+	MetricsServer metricsServer;
+	if (metricsPort == 0) {
+		metricsPort = dataManager->getMetricsPort();
+	}
+	if (metricsPort > 0 && !metricsServer.start(metricsPort)) {
+		return 1;
+	}
+
+	RunwayAssigner assigner(*dataManager);
+	assigner.setProvisionalOutput(provisional && dataManager->hasWindSnapshot());
+	AssignmentEvent result = assigner.assign(firs, [](AssignmentEvent&& event) {
+		if (event.type == AssignmentEvent::Type::AirportFailed) {
+			std::cerr << event.airport << ": " << event.detail << std::endl;
+		}
+	});
+
+	Logger::instance().flush();
+	const AssignmentTimings& timings = result.timings;
+	std::cout << "Timings (s): load " << loadSeconds << ", fetch " << timings.fetch << ", select " << timings.select
+		<< ", format " << timings.format << ", output " << timings.output << ", total " << loadSeconds + timings.total << std::endl;
+	if (!watch) {
+		return result.success ? 0 : 1;
+	}
+
+	std::signal(SIGINT, onStopSignal);
+	std::signal(SIGTERM, onStopSignal);
+	RefreshScheduler scheduler;
+	scheduler.start(dataManager->getAutoRefreshInterval(), dataManager->getAutoRefreshOffset(), [&]() {
+		AssignmentEvent refreshed = assigner.refresh(firs);
+		Logger::instance().flush();
+		std::cout << "Refresh: " << refreshed.reselected << " of " << refreshed.total << " airports reselected, .rwy "
+			<< (refreshed.rwyChanged ? "rewritten" : "unchanged") << ", " << refreshed.timings.total << " s" << std::endl;
+	});
+	while (!stopRequested) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(200));
+	}
+	scheduler.stop();
+	return 0;
+}
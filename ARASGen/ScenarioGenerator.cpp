@@ -0,0 +1,186 @@
+#include "ScenarioGenerator.h"
+#include <algorithm>
+
+constexpr uint32_t ICAO_CODES = 26 * 26 * 26 * 26;
+
+static std::string letters(uint32_t value, size_t count)
+{
+	std::string text(count, 'A');
+	for (size_t i = count; i-- > 0;) {
+		text[i] = static_cast<char>('A' + value % 26);
+		value /= 26;
+	}
+	return text;
+}
+
+ScenarioGenerator::ScenarioGenerator(const Options& options)
+	: m_options(options)
+	, m_rng(options.seed)
+{
+	m_options.airports = std::min<size_t>(m_options.airports, ICAO_CODES);
+	m_options.firs = std::clamp<size_t>(m_options.firs, 1, std::max<size_t>(m_options.airports, 1));
+
+	// i -> (step * i + offset) mod 26^4 visits every code once when step is coprime with 26^4
+	uint32_t step = below(ICAO_CODES) | 1;
+	while (step % 13 == 0) {
+		step += 2;
+	}
+	uint32_t offset = below(ICAO_CODES);
+	m_airports.reserve(m_options.airports);
+	m_airportFir.reserve(m_options.airports);
+	for (size_t i = 0; i < m_options.airports; ++i) {
+		uint32_t code = static_cast<uint32_t>((static_cast<uint64_t>(step) * i + offset) % ICAO_CODES);
+		m_airports.push_back(letters(code, 4));
+		m_airportFir.push_back(i * m_options.firs / m_options.airports);
+	}
+	for (size_t f = 0; f < m_options.firs; ++f) {
+		std::string fir = "Z";
+		fir += letters(static_cast<uint32_t>(f), 3);
+		m_firs.push_back(std::move(fir));
+	}
+}
+
+nlohmann::json ScenarioGenerator::makeRwyData()
+{
+	m_rng.seed(m_options.seed + 1);
+	nlohmann::json rwyData = nlohmann::json::object();
+	for (size_t i = 0; i < m_airports.size(); ++i) {
+		rwyData[m_airports[i]] = makeAirport(i);
+	}
+	return rwyData;
+}
+
+nlohmann::json ScenarioGenerator::makeConfig(const std::string& metarHost, const std::string& outputPath) const
+{
+	nlohmann::json firs = nlohmann::json::object();
+	for (const auto& fir : m_firs) {
+		firs[fir] = nlohmann::json::array();
+	}
+	for (size_t i = 0; i < m_airports.size(); ++i) {
+		firs[m_firs[m_airportFir[i]]].push_back(m_airports[i]);
+	}
+	for (const auto& fir : m_firs) {
+		firs[fir + "def"] = firs[fir];
+	}
+
+	// Same keys as DataManager::createDefaultConfig
+	nlohmann::json config = {
+		{"apitoken", "mock"},
+		{"tokenValidity", false},
+		{"outputPath", outputPath},
+		{"fetchConcurrency", 4},
+		{"metarBatchSize", 25},
+		{"autoRefreshInterval", 30},
+		{"autoRefreshOffset", 5},
+		{"traceRuns", false},
+		{"metricsPort", 0},
+		{"FIR", firs}
+	};
+	if (!metarHost.empty()) {
+		config["metarHost"] = metarHost;
+	}
+	return config;
+}
+
+nlohmann::json ScenarioGenerator::makeMetars()
+{
+	m_rng.seed(m_options.seed + 2);
+	nlohmann::json metars = nlohmann::json::object();
+	for (const auto& airport : m_airports) {
+		int speed = static_cast<int>(below(31));
+		nlohmann::json direction = chance(5) ? nlohmann::json(nullptr) : nlohmann::json(below(36) * 10); // VRB
+		nlohmann::json gust = chance(10) ? nlohmann::json(speed + 10 + static_cast<int>(below(11))) : nlohmann::json(nullptr);
+		metars[airport] = {
+			{"station", airport},
+			{"wind_direction", {{"value", direction}}},
+			{"wind_speed", {{"value", speed}}},
+			{"wind_gust", {{"value", gust}}}
+		};
+	}
+	return metars;
+}
+
+uint32_t ScenarioGenerator::below(uint32_t count)
+{
+	return static_cast<uint32_t>((static_cast<uint64_t>(m_rng()) * count) >> 32);
+}
+
+bool ScenarioGenerator::chance(uint32_t percent)
+{
+	return below(100) < percent;
+}
+
+std::string ScenarioGenerator::runwayNumber(int heading)
+{
+	int number = (heading + 5) / 10 % 36;
+	number = number == 0 ? 36 : number;
+	std::string name = std::to_string(number);
+	if (number < 10) {
+		name.insert(name.begin(), '0');
+	}
+	return name;
+}
+
+nlohmann::json ScenarioGenerator::makeAirport(size_t index)
+{
+	// Roughly the shipped mix: one runway used in both directions, sometimes a
+	// parallel pair, a few crosswind runways and double parallel pairs.
+	nlohmann::json airport;
+	nlohmann::json runways = nlohmann::json::object();
+	int heading = static_cast<int>(below(36)) * 10 + 10;
+	bool fourRunways = chance(2);
+	bool parallel = fourRunways || chance(30);
+	int preferred = static_cast<int>(below(2));
+	int preferential = chance(50) ? static_cast<int>(below(7)) : 0;
+
+	int variant = 1;
+	for (int direction = 0; direction < 2; ++direction) {
+		int runwayHeading = (heading + direction * 180) % 360;
+		runwayHeading = runwayHeading == 0 ? 360 : runwayHeading;
+		std::string number = runwayNumber(runwayHeading);
+		nlohmann::json config = {
+			{"heading", runwayHeading},
+			{"preferential", direction == preferred ? preferential : 0}
+		};
+		if (parallel) {
+			// Arrivals on one side, departures on the other, like LFMN
+			config["arrival"] = number + (direction == 0 ? "L" : "R");
+			config["departure"] = number + (direction == 0 ? "R" : "L");
+		}
+		else {
+			config["arrival"] = number;
+			config["departure"] = number;
+		}
+		if (fourRunways) {
+			std::string bisNumber = runwayNumber(runwayHeading + 10);
+			config["arrivalBis"] = bisNumber + (direction == 0 ? "R" : "L");
+			config["departureBis"] = bisNumber + (direction == 0 ? "L" : "R");
+		}
+		runways[std::to_string(variant++)] = config;
+	}
+
+	if (!fourRunways && chance(15)) {
+		int crossHeading = (heading + 40 + static_cast<int>(below(6)) * 10) % 360;
+		for (int direction = 0; direction < 2; ++direction) {
+			int runwayHeading = (crossHeading + direction * 180) % 360;
+			runwayHeading = runwayHeading == 0 ? 360 : runwayHeading;
+			std::string number = runwayNumber(runwayHeading);
+			runways[std::to_string(variant++)] = {
+				{"heading", runwayHeading},
+				{"preferential", 0},
+				{"arrival", number},
+				{"departure", number}
+			};
+		}
+	}
+
+	airport["runways"] = runways;
+	if (fourRunways) {
+		airport["has4runways"] = true;
+	}
+	// Satellite of the previous airport of the same FIR, like LFPB and LFPG
+	if (index > 0 && m_airportFir[index - 1] == m_airportFir[index] && chance(3)) {
+		airport["connected"] = nlohmann::json::array({ m_airports[index - 1] });
+	}
+	return airport;
+}
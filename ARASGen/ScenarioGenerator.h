@@ -0,0 +1,43 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <random>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+
+// Deterministic world-sized test data: rwydata.json in the schema RunwayIndex
+// reads, the config.json FIR map listing the same airports and an AVWX-shaped
+// METAR for every airport. The same options always give the same files, on
+// every platform (no std distributions, their output is implementation defined).
+class ScenarioGenerator {
+public:
+	struct Options {
+		size_t airports = 1000;
+		size_t firs = 10;
+		uint32_t seed = 1;
+	};
+
+	explicit ScenarioGenerator(const Options& options);
+
+	const std::vector<std::string>& getAirports() const { return m_airports; }
+	const std::vector<std::string>& getFirs() const { return m_firs; }
+
+	nlohmann::json makeRwyData();
+	// metarHost and outputPath are written as is, an empty metarHost keeps the real AVWX
+	nlohmann::json makeConfig(const std::string& metarHost, const std::string& outputPath) const;
+	// Station -> METAR without "time", the mock server stamps the current issuance
+	nlohmann::json makeMetars();
+
+private:
+	uint32_t below(uint32_t count); // uniform in [0, count)
+	bool chance(uint32_t percent);
+	static std::string runwayNumber(int heading);
+	nlohmann::json makeAirport(size_t index);
+
+private:
+	Options m_options;
+	std::mt19937 m_rng;
+	std::vector<std::string> m_airports;
+	std::vector<std::string> m_firs;
+	std::vector<size_t> m_airportFir; // index in m_firs of each airport
+};
@@ -0,0 +1,190 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <csignal>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <stdexcept>
+
+#define CPPHTTPLIB_OPENSSL_SUPPORT
+#include <httplib.h>
+
+#include "ScenarioGenerator.h"
+
+constexpr int DEFAULT_PORT = 8990;
+
+static std::atomic<bool> stopRequested{ false };
+
+static void onStopSignal(int)
+{
+	stopRequested = true;
+}
+
+// Scale test data for aras-cli, aras-bench and the GUI, plus a local stand-in for AVWX.
+static void printUsage()
+{
+	std::cout << "Usage: aras-gen --out DIR [--airports N] [--firs N] [--seed N] [--port PORT]\n"
+		<< "       aras-gen serve --data DIR [--port PORT] [--latency MS]\n"
+		<< "  --out DIR      writes rwydata.json, config.json and metars.json to DIR\n"
+		<< "  --airports N   number of airports (default 1000, at most 456976)\n"
+		<< "  --firs N       number of FIRs the airports are split into (default 10)\n"
+		<< "  --seed N       same seed, same files (default 1)\n"
+		<< "  --port PORT    mock server port written to config.json as metarHost, 0 keeps AVWX (default 8990)\n"
+		<< "  serve          answers /api/metar/ and /api/multi/metar/ from DIR/metars.json\n"
+		<< "  --latency MS   delay added to every mock response" << std::endl;
+}
+
+static bool writeJson(const std::filesystem::path& path, const nlohmann::json& json)
+{
+	std::ofstream file(path, std::ios::binary);
+	if (!file.is_open()) {
+		std::cerr << "Could not write " << path.string() << std::endl;
+		return false;
+	}
+	file << json.dump(1, '\t');
+	return file.good();
+}
+
+// Start of the current half hour, METARs are issued at :00 and :30
+static std::string currentIssuance()
+{
+	std::time_t now = std::time(nullptr);
+	now -= now % (30 * 60);
+	std::tm utc{};
+#ifdef _WIN32
+	gmtime_s(&utc, &now);
+#else
+	gmtime_r(&now, &utc);
+#endif
+	char buffer[32];
+	std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%SZ", &utc);
+	return buffer;
+}
+
+static int generate(const std::filesystem::path& directory, const ScenarioGenerator::Options& options, int port)
+{
+	std::error_code error;
+	std::filesystem::create_directories(directory, error);
+	std::filesystem::path absolute = std::filesystem::absolute(directory, error);
+
+	ScenarioGenerator generator(options);
+	std::string metarHost = port > 0 ? "http://127.0.0.1:" + std::to_string(port) : std::string();
+	if (!writeJson(directory / "rwydata.json", generator.makeRwyData())
+		|| !writeJson(directory / "config.json", generator.makeConfig(metarHost, (absolute / "aras.rwy").string()))
+		|| !writeJson(directory / "metars.json", generator.makeMetars())) {
+		return 1;
+	}
+	std::cout << generator.getAirports().size() << " airports in " << generator.getFirs().size() << " FIRs written to "
+		<< absolute.string() << std::endl;
+	return 0;
+}
+
+static int serve(const std::filesystem::path& directory, int port, std::chrono::milliseconds latency)
+{
+	std::ifstream file(directory / "metars.json");
+	nlohmann::json metars = nlohmann::json::parse(file, nullptr, false);
+	if (!metars.is_object()) {
+		std::cerr << "No metars.json in " << directory.string() << ", run aras-gen --out first." << std::endl;
+		return 1;
+	}
+
+	auto findMetar = [&metars](const std::string& station) -> nlohmann::json {
+		auto it = metars.find(station);
+		if (it == metars.end()) {
+			return nullptr;
+		}
+		nlohmann::json metar = *it;
+		metar["time"] = { {"dt", currentIssuance()} };
+		return metar;
+	};
+
+	httplib::Server server;
+	server.set_tcp_nodelay(true); // headers and body are separate writes, Nagle would hold the body for the client's delayed ACK
+	server.Get(R"(/api/metar/([A-Za-z0-9]+))", [&](const httplib::Request& req, httplib::Response& res) {
+		std::this_thread::sleep_for(latency);
+		nlohmann::json metar = findMetar(req.matches[1]);
+		if (metar.is_null()) {
+			res.status = 400;
+			res.set_content(R"({"error":"unknown station"})", "application/json");
+			return;
+		}
+		res.set_content(metar.dump(), "application/json");
+	});
+	server.Get(R"(/api/multi/metar/([A-Za-z0-9,]+))", [&](const httplib::Request& req, httplib::Response& res) {
+		std::this_thread::sleep_for(latency);
+		nlohmann::json response = nlohmann::json::array();
+		std::string stations = req.matches[1];
+		size_t start = 0;
+		while (start <= stations.size()) {
+			size_t end = stations.find(',', start);
+			if (end == std::string::npos) end = stations.size();
+			nlohmann::json metar = findMetar(stations.substr(start, end - start));
+			if (!metar.is_null()) {
+				response.push_back(std::move(metar));
+			}
+			start = end + 1;
+		}
+		res.set_content(response.dump(), "application/json");
+	});
+
+	if (!server.bind_to_port("127.0.0.1", port)) {
+		std::cerr << "Could not listen on port " << port << std::endl;
+		return 1;
+	}
+	std::signal(SIGINT, onStopSignal);
+	std::signal(SIGTERM, onStopSignal);
+	std::thread listener([&server]() { server.listen_after_bind(); });
+	server.wait_until_ready();
+	std::cout << "Serving " << metars.size() << " METARs on http://127.0.0.1:" << port << std::endl;
+	while (!stopRequested) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(200));
+	}
+	server.stop();
+	listener.join();
+	return 0;
+}
+
+int main(int argc, char* argv[])
+{
+	bool serveMode = argc > 1 && std::string(argv[1]) == "serve";
+	std::filesystem::path directory;
+	ScenarioGenerator::Options options;
+	int port = DEFAULT_PORT;
+	int latency = 0;
+
+	for (int i = serveMode ? 2 : 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+		try {
+			if ((arg == "--out" || arg == "--data") && hasValue) directory = argv[++i];
+			else if (arg == "--airports" && hasValue) options.airports = std::stoul(argv[++i]);
+			else if (arg == "--firs" && hasValue) options.firs = std::stoul(argv[++i]);
+			else if (arg == "--seed" && hasValue) options.seed = static_cast<uint32_t>(std::stoul(argv[++i]));
+			else if (arg == "--port" && hasValue) port = std::stoi(argv[++i]);
+			else if (arg == "--latency" && hasValue) latency = std::stoi(argv[++i]);
+			else {
+				printUsage();
+				return arg == "--help" || arg == "-h" ? 0 : 2;
+			}
+		}
+		catch (const std::logic_error&) { // std::invalid_argument and std::out_of_range
+			std::cerr << "Invalid value for " << arg << ": " << argv[i] << std::endl;
+			printUsage();
+			return 2;
+		}
+	}
+	if (directory.empty()) {
+		printUsage();
+		return 2;
+	}
+
+	if (serveMode) {
+		return serve(directory, port, std::chrono::milliseconds{ latency });
+	}
+	return generate(directory, options, port);
+}